@@ -0,0 +1,500 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <latch>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <zdm/latency_histogram.hpp>
+#include <zdm/lock_wrapper.hpp>
+#include <zdm/shared_lock_wrapper.hpp>
+
+#if defined( __linux__ )
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace zdm::bench {
+
+using clock = std::chrono::steady_clock;
+
+/**
+ * @brief `--name=value` command line options.
+ */
+class arguments
+{
+    public:
+        arguments(
+            int    a_argc,
+            char **a_argv
+        )
+        {
+            for( int i = 1; i < a_argc; ++i )
+            {
+                std::string_view argument( a_argv[i] );
+
+                if( !argument.starts_with( "--" ) )
+                {
+                    continue;
+                }
+
+                argument.remove_prefix( 2 );
+
+                const auto equals = argument.find( '=' );
+
+                if( equals == std::string_view::npos )
+                {
+                    m_values.emplace( argument, "1" );
+                }
+                else
+                {
+                    m_values.emplace(
+                        argument.substr( 0, equals ),
+                        argument.substr( equals + 1 )
+                    );
+                }
+            }
+        }
+
+        std::uint64_t
+        number(
+            const std::string &a_name,
+            std::uint64_t      a_default
+        ) const
+        {
+            const auto found = m_values.find( a_name );
+            return found == m_values.end()
+                     ? a_default
+                     : std::strtoull( found->second.c_str(), nullptr, 10 );
+        }
+
+        std::string
+        text(
+            const std::string &a_name,
+            std::string        a_default
+        ) const
+        {
+            const auto found = m_values.find( a_name );
+            return found == m_values.end() ? a_default : found->second;
+        }
+
+        bool
+        flag(
+            const std::string &a_name
+        ) const
+        {
+            return number( a_name, 0 ) != 0;
+        }
+
+    private:
+        std::map<std::string, std::string, std::less<>> m_values;
+};
+
+/**
+ * @brief Busy waits, simulating work that keeps the CPU occupied.
+ */
+inline void
+spin_for(
+    std::chrono::nanoseconds a_duration
+)
+{
+    if( a_duration.count() <= 0 )
+    {
+        return;
+    }
+
+    const auto end = clock::now() + a_duration;
+
+    while( clock::now() < end )
+    {
+    }
+}
+
+/**
+ * @brief The CPUs this process may run on, in ascending order.
+ */
+inline std::vector<unsigned>
+allowed_cpus()
+{
+    std::vector<unsigned> cpus;
+
+#if defined( __linux__ )
+    cpu_set_t set;
+    CPU_ZERO( &set );
+
+    if( sched_getaffinity( 0, sizeof( set ), &set ) == 0 )
+    {
+        for( unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu )
+        {
+            if( CPU_ISSET( cpu, &set ) )
+            {
+                cpus.push_back( cpu );
+            }
+        }
+    }
+#endif
+
+    if( cpus.empty() )
+    {
+        for( unsigned cpu = 0;
+             cpu < std::max( std::thread::hardware_concurrency(), 1U );
+             ++cpu )
+        {
+            cpus.push_back( cpu );
+        }
+    }
+
+    return cpus;
+}
+
+/**
+ * @brief Pins the calling thread to one CPU.
+ *
+ * @return `false` where pinning is not supported or was refused.
+ */
+inline bool
+pin_current_thread(
+    [[maybe_unused]] unsigned a_cpu
+)
+{
+#if defined( __linux__ )
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    CPU_SET( a_cpu, &set );
+    return pthread_setaffinity_np( pthread_self(), sizeof( set ), &set ) == 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Where a CPU sits in the machine's topology.
+ */
+struct cpu_info
+{
+        unsigned cpu       = 0;
+        unsigned package   = 0;
+        unsigned core      = 0;
+        unsigned smt_index = 0;
+};
+
+/**
+ * @brief The topology of the allowed CPUs, read from Linux sysfs.
+ *
+ * Where sysfs is not available, every CPU is reported as its own core on a
+ * single package.
+ */
+inline std::vector<cpu_info>
+cpu_topology()
+{
+    std::vector<cpu_info> topology;
+
+    for( const auto cpu : allowed_cpus() )
+    {
+        const auto directory = "/sys/devices/system/cpu/cpu"
+                             + std::to_string( cpu ) + "/topology/";
+        cpu_info   info{ .cpu = cpu, .core = cpu };
+
+        std::ifstream( directory + "physical_package_id" ) >> info.package;
+        std::ifstream( directory + "core_id" ) >> info.core;
+        topology.push_back( info );
+    }
+
+    std::ranges::sort(
+        topology,
+        {},
+        []( const cpu_info &a_info )
+        {
+            return std::tuple( a_info.package, a_info.core, a_info.cpu );
+        }
+    );
+
+    for( std::size_t i = 1; i < topology.size(); ++i )
+    {
+        if( topology[i].package == topology[i - 1].package
+            && topology[i].core == topology[i - 1].core )
+        {
+            topology[i].smt_index = topology[i - 1].smt_index + 1;
+        }
+    }
+
+    return topology;
+}
+
+/**
+ * @brief How threads are placed on the CPUs as their number grows.
+ */
+enum class placement
+{
+    /** @brief Fill both SMT siblings of a core before the next core. */
+    smt_siblings,
+    /** @brief Fill the cores of one package before the next package. */
+    same_socket,
+    /** @brief Alternate between packages and use SMT siblings last. */
+    spread
+};
+
+inline const char *
+placement_name(
+    placement a_placement
+) noexcept
+{
+    switch( a_placement )
+    {
+    case placement::smt_siblings:
+        return "smt";
+    case placement::same_socket:
+        return "socket";
+    case placement::spread:
+        return "spread";
+    }
+
+    return "unknown";
+}
+
+/**
+ * @brief The CPUs in the order threads are pinned to them.
+ */
+inline std::vector<unsigned>
+placement_order(
+    placement a_placement
+)
+{
+    auto topology = cpu_topology();
+
+    // Ranks the cores of every package so that spreading can alternate
+    // between packages core by core.
+    std::map<std::pair<unsigned, unsigned>, unsigned> core_rank;
+    std::map<unsigned, unsigned>                      cores_in_package;
+
+    for( const auto &info : topology )
+    {
+        const auto core = std::pair( info.package, info.core );
+
+        if( !core_rank.contains( core ) )
+        {
+            core_rank[core] = cores_in_package[info.package]++;
+        }
+    }
+
+    const auto key = [&]( const cpu_info &a_info )
+    {
+        const auto rank = core_rank.at( { a_info.package, a_info.core } );
+
+        switch( a_placement )
+        {
+        case placement::smt_siblings:
+            return std::tuple( a_info.package, rank, a_info.smt_index );
+        case placement::same_socket:
+            return std::tuple( a_info.package, a_info.smt_index, rank );
+        case placement::spread:
+            break;
+        }
+
+        return std::tuple( a_info.smt_index, rank, a_info.package );
+    };
+
+    std::ranges::sort(
+        topology,
+        [&]( const cpu_info &a_left, const cpu_info &a_right )
+        {
+            return key( a_left ) < key( a_right );
+        }
+    );
+
+    std::vector<unsigned> order;
+
+    for( const auto &info : topology )
+    {
+        order.push_back( info.cpu );
+    }
+
+    return order;
+}
+
+/**
+ * @brief The contention a benchmark run puts on a wrapper.
+ */
+struct configuration
+{
+        std::size_t              threads = 1;
+        std::chrono::nanoseconds duration{ std::chrono::seconds( 1 ) };
+        std::chrono::nanoseconds hold{ 100 };
+        std::chrono::nanoseconds think{ 0 };
+        std::uint64_t            read_percent = 0;
+        /** @brief Worker `i` runs on `cpus[i % cpus.size()]`, unpinned if
+         * empty. */
+        std::vector<unsigned>    cpus;
+};
+
+/**
+ * @brief Reads the common `--threads`, `--duration-ms`, `--hold-ns`,
+ * `--think-ns` and `--read-percent` options.
+ */
+inline configuration
+configuration_from(
+    const arguments &a_arguments
+)
+{
+    configuration result;
+    result.threads
+        = a_arguments.number( "threads", allowed_cpus().size() );
+    result.duration = std::chrono::milliseconds(
+        a_arguments.number( "duration-ms", 1000 )
+    );
+    result.hold
+        = std::chrono::nanoseconds( a_arguments.number( "hold-ns", 100 ) );
+    result.think
+        = std::chrono::nanoseconds( a_arguments.number( "think-ns", 0 ) );
+    result.read_percent = a_arguments.number( "read-percent", 0 );
+    return result;
+}
+
+struct measurement
+{
+        /** @brief Time from calling `with_lock` until the function runs, in
+         * nanoseconds. */
+        zdm::latency_histogram latency;
+        double                 seconds = 0;
+
+        double
+        operations_per_second() const noexcept
+        {
+            return static_cast<double>( latency.count() ) / seconds;
+        }
+};
+
+/**
+ * @brief Hammers one wrapper from `a_configuration.threads` threads and
+ * records the acquisition latency of every `with_lock` call.
+ */
+template <class AWrapper>
+measurement
+measure(
+    const configuration &a_configuration
+)
+{
+    AWrapper                            wrapper;
+    std::vector<zdm::latency_histogram> histograms( a_configuration.threads );
+    std::vector<std::thread>            threads;
+    std::latch                          ready(
+        static_cast<std::ptrdiff_t>( a_configuration.threads + 1 )
+    );
+    std::atomic<bool>                   stop{ false };
+
+    for( std::size_t i = 0; i < a_configuration.threads; ++i )
+    {
+        threads.emplace_back(
+            [&, i]()
+            {
+                const auto &cpus = a_configuration.cpus;
+
+                if( !cpus.empty() )
+                {
+                    pin_current_thread( cpus[i % cpus.size()] );
+                }
+
+                auto         &histogram = histograms[i];
+                std::uint64_t random    = 0x9E3779B97F4A7C15ULL * ( i + 1 );
+
+                ready.arrive_and_wait();
+
+                while( !stop.load( std::memory_order_relaxed ) )
+                {
+                    random ^= random << 13;
+                    random ^= random >> 7;
+                    random ^= random << 17;
+
+                    const auto start    = clock::now();
+                    auto       acquired = start;
+
+                    if( random % 100 < a_configuration.read_percent )
+                    {
+                        wrapper.with_lock(
+                            [&]( const std::uint64_t & )
+                            {
+                                acquired = clock::now();
+                                spin_for( a_configuration.hold );
+                            }
+                        );
+                    }
+                    else
+                    {
+                        wrapper.with_lock(
+                            [&]( std::uint64_t &a_value )
+                            {
+                                acquired = clock::now();
+                                ++a_value;
+                                spin_for( a_configuration.hold );
+                            }
+                        );
+                    }
+
+                    histogram.record( static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            acquired - start
+                        )
+                            .count()
+                    ) );
+
+                    spin_for( a_configuration.think );
+                }
+            }
+        );
+    }
+
+    ready.arrive_and_wait();
+    const auto start = clock::now();
+    std::this_thread::sleep_for( a_configuration.duration );
+    stop.store( true );
+
+    for( auto &thread : threads )
+    {
+        thread.join();
+    }
+
+    const auto  elapsed = clock::now() - start;
+
+    measurement result;
+    result.seconds = std::chrono::duration<double>( elapsed ).count();
+
+    for( const auto &histogram : histograms )
+    {
+        result.latency.merge( histogram );
+    }
+
+    return result;
+}
+
+/**
+ * @brief Calls `a_function.template operator()<Wrapper>( name )` for every
+ * wrapper type shipped with the library.
+ */
+template <class AContainedType, class AFunction>
+void
+for_each_wrapper_type(
+    AFunction &&a_function
+)
+{
+    a_function.template operator()<zdm::lock_wrapper<AContainedType>>(
+        "lock_wrapper"
+    );
+    a_function.template operator()<zdm::shared_lock_wrapper<AContainedType>>(
+        "shared_lock_wrapper"
+    );
+    a_function
+        .template operator()<zdm::recursive_lock_wrapper<AContainedType>>(
+            "recursive_lock_wrapper"
+        );
+}
+
+} // namespace zdm::bench
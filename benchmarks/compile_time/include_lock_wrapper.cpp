@@ -0,0 +1,4 @@
+/**
+ * @brief The cost of including `zdm/lock_wrapper.hpp`.
+ */
+#include <zdm/lock_wrapper.hpp>
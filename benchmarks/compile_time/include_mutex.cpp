@@ -0,0 +1,4 @@
+/**
+ * @brief The baseline: the cost of including `<mutex>` alone.
+ */
+#include <mutex>
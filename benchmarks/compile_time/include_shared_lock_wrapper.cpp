@@ -0,0 +1,4 @@
+/**
+ * @brief The cost of including `zdm/shared_lock_wrapper.hpp`.
+ */
+#include <zdm/shared_lock_wrapper.hpp>
@@ -0,0 +1,53 @@
+# Measures how long the compiler takes to parse and instantiate each
+# translation unit of this directory, reporting the median of REPEATS runs.
+#
+# Usage: cmake -DCXX=<compiler> -DCXX_FLAGS=<flags> -DINCLUDE_DIR=<include>
+#              [-DREPEATS=<n>] -P measure_compile_time.cmake
+
+cmake_minimum_required(VERSION 3.27)
+
+if(NOT CXX OR NOT INCLUDE_DIR)
+  message(FATAL_ERROR "CXX and INCLUDE_DIR must be set")
+endif()
+
+if(NOT REPEATS)
+  set(REPEATS 5)
+endif()
+
+separate_arguments(flags NATIVE_COMMAND "${CXX_FLAGS}")
+file(GLOB sources "${CMAKE_CURRENT_LIST_DIR}/*.cpp")
+list(SORT sources)
+
+message(STATUS "median of ${REPEATS} runs, -fsyntax-only")
+
+foreach(source IN LISTS sources)
+  get_filename_component(name "${source}" NAME_WE)
+  set(times "")
+
+  foreach(run RANGE 1 ${REPEATS})
+    string(TIMESTAMP start "%s%f" UTC)
+    execute_process(
+      COMMAND "${CXX}" ${flags} "-I${INCLUDE_DIR}" -fsyntax-only "${source}"
+      RESULT_VARIABLE result
+      ERROR_VARIABLE errors
+    )
+    string(TIMESTAMP end "%s%f" UTC)
+
+    if(NOT result EQUAL 0)
+      message(FATAL_ERROR "${name} does not compile:\n${errors}")
+    endif()
+
+    math(EXPR elapsed "(${end} - ${start}) / 1000")
+    # Zero padded, so that the lexical sort below is numeric.
+    string(LENGTH "${elapsed}" digits)
+    math(EXPR padding "10 - ${digits}")
+    string(REPEAT "0" ${padding} zeros)
+    list(APPEND times "${zeros}${elapsed}")
+  endforeach()
+
+  list(SORT times)
+  math(EXPR middle "${REPEATS} / 2")
+  list(GET times ${middle} median)
+  math(EXPR median "${median}")
+  message(STATUS "${name}: ${median} ms")
+endforeach()
@@ -0,0 +1,41 @@
+/**
+ * @brief The hand-written equivalent of `with_lock_calls.cpp`.
+ */
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+#ifndef ZDM_COMPILE_TIME_CALLS
+#define ZDM_COMPILE_TIME_CALLS 200
+#endif
+
+template <std::size_t... AIndices>
+int
+call_all(
+    std::mutex &a_mutex,
+    int        &a_value,
+    std::index_sequence<AIndices...>
+)
+{
+    return (
+        [&a_mutex]( int& value )
+        {
+            std::scoped_lock lock( a_mutex );
+            return value + static_cast<int>( AIndices );
+        }( a_value )
+        + ...
+    );
+}
+
+int
+compile_time_entry(
+    std::mutex &a_mutex,
+    int        &a_value
+)
+{
+    return call_all(
+        a_mutex,
+        a_value,
+        std::make_index_sequence<ZDM_COMPILE_TIME_CALLS>()
+    );
+}
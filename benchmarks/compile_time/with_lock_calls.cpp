@@ -0,0 +1,41 @@
+/**
+ * @brief The cost of `ZDM_COMPILE_TIME_CALLS` `with_lock` calls, each with a
+ * lambda of its own type, as a translation unit using the wrapper heavily
+ * would have. Compare with `scoped_lock_calls.cpp`.
+ */
+#include <cstddef>
+#include <utility>
+#include <zdm/lock_wrapper.hpp>
+
+#ifndef ZDM_COMPILE_TIME_CALLS
+#define ZDM_COMPILE_TIME_CALLS 200
+#endif
+
+template <std::size_t... AIndices>
+int
+call_all(
+    zdm::lock_wrapper<int> &a_wrapper,
+    std::index_sequence<AIndices...>
+)
+{
+    return (
+        a_wrapper.with_lock(
+            []( int& value )
+            {
+                return value + static_cast<int>( AIndices );
+            }
+        )
+        + ...
+    );
+}
+
+int
+compile_time_entry(
+    zdm::lock_wrapper<int> &a_wrapper
+)
+{
+    return call_all(
+        a_wrapper,
+        std::make_index_sequence<ZDM_COMPILE_TIME_CALLS>()
+    );
+}
@@ -0,0 +1,312 @@
+/**
+ * @brief Replays a recorded lock trace against every wrapper type.
+ *
+ * Usage:
+ * - `zdm_lock_wrapper_replay --trace=PATH` replays the trace. Every recorded
+ * thread becomes a replay thread that, for each of its events, busy waits for
+ * the recorded time between its previous release and the event, with the
+ * first event of the whole trace as every thread's starting point, then locks
+ * the event's wrapper in the recorded mode and holds it for the recorded
+ * hold time. Wait times therefore reflect the lock type under test, while
+ * the access pattern stays the one that was recorded.
+ * - `zdm_lock_wrapper_replay --record=PATH` records a synthetic trace from an
+ * instrumented wrapper, using the options of `zdm_lock_wrapper_latency`.
+ * - `zdm_lock_wrapper_replay --trace=PATH --chrome=OUT` converts the trace to
+ * Chrome Trace Event JSON, viewable in Perfetto, instead of replaying it.
+ *
+ * The report lists the recorded wait times next to those of each replay.
+ */
+#include "bench_common.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <latch>
+#include <map>
+#include <thread>
+#include <vector>
+#include <zdm/chrome_trace.hpp>
+#include <zdm/latency_histogram.hpp>
+#include <zdm/lock_trace.hpp>
+
+namespace {
+
+using zdm::instrumentation::lock_event;
+using zdm::instrumentation::lock_mode;
+using zdm::instrumentation::lock_trace;
+
+void
+print_row(
+    const char                   *a_name,
+    double                        a_seconds,
+    const zdm::latency_histogram &a_wait
+)
+{
+    std::printf(
+        "%-24s %12.3f %14.0f %10llu %10llu %10llu %12llu\n",
+        a_name,
+        a_seconds,
+        static_cast<double>( a_wait.count() ) / a_seconds,
+        static_cast<unsigned long long>( a_wait.value_at_percentile( 50.0 ) ),
+        static_cast<unsigned long long>( a_wait.value_at_percentile( 99.0 ) ),
+        static_cast<unsigned long long>( a_wait.value_at_percentile( 99.9 ) ),
+        static_cast<unsigned long long>( a_wait.max() )
+    );
+}
+
+/**
+ * @brief The events of every recorded thread, with the wrapper ids mapped to
+ * dense indices.
+ */
+struct replay_plan
+{
+        std::vector<std::vector<lock_event>> threads;
+        std::size_t                          wrappers = 0;
+        /** @brief The earliest `start_ns` of the whole trace. */
+        std::uint64_t                        origin   = 0;
+};
+
+replay_plan
+make_plan(
+    const lock_trace &a_trace
+)
+{
+    replay_plan                             result;
+    std::map<std::uint32_t, std::uint32_t> wrapper_index;
+    std::map<std::uint32_t, std::size_t>   thread_index;
+
+    if( !a_trace.events.empty() )
+    {
+        result.origin = std::ranges::min(
+            a_trace.events,
+            {},
+            &lock_event::start_ns
+        ).start_ns;
+    }
+
+    for( auto event : a_trace.events )
+    {
+        const auto wrapper = wrapper_index.emplace(
+            event.wrapper,
+            static_cast<std::uint32_t>( wrapper_index.size() )
+        );
+        const auto thread
+            = thread_index.emplace( event.thread, thread_index.size() );
+
+        if( thread.second )
+        {
+            result.threads.emplace_back();
+        }
+
+        event.wrapper = wrapper.first->second;
+        result.threads[thread.first->second].push_back( event );
+    }
+
+    result.wrappers = wrapper_index.size();
+    return result;
+}
+
+template <class AWrapper>
+void
+replay(
+    const char        *a_name,
+    const replay_plan &a_plan
+)
+{
+    std::vector<AWrapper>               wrappers( a_plan.wrappers );
+    std::vector<zdm::latency_histogram> waits( a_plan.threads.size() );
+    std::vector<std::thread>            threads;
+    std::latch                          ready(
+        static_cast<std::ptrdiff_t>( a_plan.threads.size() + 1 )
+    );
+
+    for( std::size_t t = 0; t < a_plan.threads.size(); ++t )
+    {
+        threads.emplace_back(
+            [&, t]()
+            {
+                const auto   &events          = a_plan.threads[t];
+                std::uint64_t previous_release = a_plan.origin;
+
+                ready.arrive_and_wait();
+
+                for( const auto &event : events )
+                {
+                    if( event.start_ns > previous_release )
+                    {
+                        zdm::bench::spin_for( std::chrono::nanoseconds(
+                            event.start_ns - previous_release
+                        ) );
+                    }
+
+                    previous_release
+                        = event.start_ns + event.wait_ns + event.hold_ns;
+
+                    const auto hold = std::chrono::nanoseconds( event.hold_ns );
+                    const auto start    = zdm::bench::clock::now();
+                    auto       acquired = start;
+                    auto      &wrapper  = wrappers[event.wrapper];
+
+                    if( event.mode == lock_mode::shared )
+                    {
+                        wrapper.with_lock(
+                            [&]( const std::uint64_t & )
+                            {
+                                acquired = zdm::bench::clock::now();
+                                zdm::bench::spin_for( hold );
+                            }
+                        );
+                    }
+                    else
+                    {
+                        wrapper.with_lock(
+                            [&]( std::uint64_t &a_value )
+                            {
+                                acquired = zdm::bench::clock::now();
+                                ++a_value;
+                                zdm::bench::spin_for( hold );
+                            }
+                        );
+                    }
+
+                    waits[t].record( static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            acquired - start
+                        )
+                            .count()
+                    ) );
+                }
+            }
+        );
+    }
+
+    ready.arrive_and_wait();
+    const auto start = zdm::bench::clock::now();
+
+    for( auto &thread : threads )
+    {
+        thread.join();
+    }
+
+    const auto             elapsed = zdm::bench::clock::now() - start;
+    zdm::latency_histogram wait;
+
+    for( const auto &histogram : waits )
+    {
+        wait.merge( histogram );
+    }
+
+    print_row( a_name, std::chrono::duration<double>( elapsed ).count(), wait );
+}
+
+int
+record(
+    const zdm::bench::arguments &a_arguments,
+    const std::string           &a_path
+)
+{
+    auto configuration = zdm::bench::configuration_from( a_arguments );
+    configuration.duration
+        = std::chrono::milliseconds( a_arguments.number( "duration-ms", 100 ) );
+
+    zdm::instrumentation::trace_recorder recorder;
+    recorder.start();
+    zdm::bench::measure<zdm::instrumented_shared_lock_wrapper<std::uint64_t>>(
+        configuration
+    );
+
+    std::ofstream stream( a_path, std::ios::binary );
+    zdm::instrumentation::write_trace( stream, recorder.take() );
+    return stream ? 0 : 1;
+}
+
+} // namespace
+
+int
+main(
+    int    argc,
+    char **argv
+)
+{
+    const zdm::bench::arguments arguments( argc, argv );
+
+    if( const auto path = arguments.text( "record", "" ); !path.empty() )
+    {
+        return record( arguments, path );
+    }
+
+    std::ifstream stream(
+        arguments.text( "trace", "trace.bin" ),
+        std::ios::binary
+    );
+
+    if( !stream )
+    {
+        std::fprintf(
+            stderr,
+            "usage: %s --trace=PATH [--chrome=OUT] | --record=PATH\n",
+            argv[0]
+        );
+        return 1;
+    }
+
+    const auto trace = zdm::instrumentation::read_trace( stream );
+
+    if( const auto path = arguments.text( "chrome", "" ); !path.empty() )
+    {
+        std::ofstream output( path );
+        zdm::instrumentation::write_chrome_trace( output, trace );
+        return output ? 0 : 1;
+    }
+
+    const auto plan = make_plan( trace );
+
+    if( trace.events.empty() )
+    {
+        std::fprintf( stderr, "the trace holds no events\n" );
+        return 1;
+    }
+
+    std::printf(
+        "%zu events, %zu threads, %zu wrappers\n",
+        trace.events.size(),
+        plan.threads.size(),
+        plan.wrappers
+    );
+    std::printf(
+        "%-24s %12s %14s %10s %10s %10s %12s\n",
+        "wrapper",
+        "seconds",
+        "events/s",
+        "p50 ns",
+        "p99 ns",
+        "p99.9 ns",
+        "max ns"
+    );
+
+    zdm::latency_histogram recorded_wait;
+
+    for( const auto &event : trace.events )
+    {
+        recorded_wait.record( event.wait_ns );
+    }
+
+    const auto &last = trace.events.back();
+    print_row(
+        "recorded",
+        static_cast<double>(
+            last.start_ns + last.wait_ns + last.hold_ns
+            - trace.events.front().start_ns
+        ) / 1e9,
+        recorded_wait
+    );
+
+    zdm::bench::for_each_wrapper_type<std::uint64_t>(
+        [&]<class AWrapper>( const char *a_name )
+        {
+            replay<AWrapper>( a_name, plan );
+        }
+    );
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * @brief Throughput scaling of every wrapper type over the number of cores.
+ *
+ * For every wrapper type and thread placement, the thread count is swept from
+ * one to the number of allowed CPUs. Every point is written to a CSV file and
+ * a summary table reports the peak of each curve and where it falls off.
+ *
+ * Placements:
+ * - `smt`: threads fill both SMT siblings of a core before the next core.
+ * - `socket`: threads fill the cores of one package before the next package.
+ * - `spread`: threads alternate between packages, SMT siblings last.
+ *
+ * Options:
+ * - `--max-threads=N`: last point of the sweep, at least 1, defaults to all
+ * CPUs.
+ * - `--csv=PATH`: the scaling curves, defaults to `scaling.csv`.
+ * - `--cliff-percent=N`: a curve falls off once throughput drops below N% of
+ * its peak after the peak, defaults to 80.
+ * - `--duration-ms`, `--hold-ns`, `--think-ns`, `--read-percent`: as for
+ * `zdm_lock_wrapper_latency`.
+ */
+#include "bench_common.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <ios>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct curve_point
+{
+        std::size_t threads;
+        double      operations_per_second;
+};
+
+/**
+ * @brief The first thread count after the peak whose throughput drops below
+ * `a_cliff` times the peak, or zero if the curve never does.
+ */
+std::size_t
+cliff_threads(
+    const std::vector<curve_point> &a_curve,
+    std::size_t                     a_peak,
+    double                          a_cliff
+)
+{
+    for( std::size_t i = a_peak + 1; i < a_curve.size(); ++i )
+    {
+        if( a_curve[i].operations_per_second
+            < a_cliff * a_curve[a_peak].operations_per_second )
+        {
+            return a_curve[i].threads;
+        }
+    }
+
+    return 0;
+}
+
+} // namespace
+
+int
+main(
+    int    argc,
+    char **argv
+)
+{
+    const zdm::bench::arguments arguments( argc, argv );
+    auto                        configuration
+        = zdm::bench::configuration_from( arguments );
+    const auto max_threads = arguments.number(
+        "max-threads",
+        zdm::bench::allowed_cpus().size()
+    );
+    const auto cliff
+        = static_cast<double>( arguments.number( "cliff-percent", 80 ) )
+        / 100.0;
+
+    if( max_threads < 1 )
+    {
+        std::fprintf( stderr, "--max-threads must be at least 1\n" );
+        return 1;
+    }
+
+    std::ofstream csv( arguments.text( "csv", "scaling.csv" ) );
+    csv << std::fixed;
+    csv.precision( 0 );
+    csv << "wrapper,placement,threads,ops_per_second,p50_ns,p99_ns,p999_ns,"
+           "max_ns\n";
+
+    std::printf(
+        "%-24s %-8s %14s %8s %14s %10s %8s\n",
+        "wrapper",
+        "place",
+        "1 thread ops/s",
+        "peak at",
+        "peak ops/s",
+        "speedup",
+        "cliff at"
+    );
+
+    zdm::bench::for_each_wrapper_type<std::uint64_t>(
+        [&]<class AWrapper>( const char *a_name )
+        {
+            for( const auto placement :
+                 { zdm::bench::placement::smt_siblings,
+                   zdm::bench::placement::same_socket,
+                   zdm::bench::placement::spread } )
+            {
+                configuration.cpus = zdm::bench::placement_order( placement );
+
+                std::vector<curve_point> curve;
+                std::size_t              peak = 0;
+
+                for( std::size_t threads = 1; threads <= max_threads;
+                     ++threads )
+                {
+                    configuration.threads = threads;
+
+                    const auto measured
+                        = zdm::bench::measure<AWrapper>( configuration );
+                    const auto &latency = measured.latency;
+
+                    csv << a_name << ','
+                        << zdm::bench::placement_name( placement ) << ','
+                        << threads << ','
+                        << measured.operations_per_second() << ','
+                        << latency.value_at_percentile( 50.0 ) << ','
+                        << latency.value_at_percentile( 99.0 ) << ','
+                        << latency.value_at_percentile( 99.9 ) << ','
+                        << latency.max() << '\n';
+
+                    curve.push_back(
+                        { threads, measured.operations_per_second() }
+                    );
+
+                    if( curve.back().operations_per_second
+                        > curve[peak].operations_per_second )
+                    {
+                        peak = curve.size() - 1;
+                    }
+                }
+
+                const auto cliff_at = cliff_threads( curve, peak, cliff );
+
+                std::printf(
+                    "%-24s %-8s %14.0f %8zu %14.0f %9.2fx %8s\n",
+                    a_name,
+                    zdm::bench::placement_name( placement ),
+                    curve.front().operations_per_second,
+                    curve[peak].threads,
+                    curve[peak].operations_per_second,
+                    curve.back().operations_per_second
+                        / curve.front().operations_per_second,
+                    cliff_at ? std::to_string( cliff_at ).c_str() : "-"
+                );
+            }
+        }
+    );
+
+    return 0;
+}
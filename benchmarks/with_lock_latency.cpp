@@ -0,0 +1,74 @@
+/**
+ * @brief Tail latency of `with_lock` for every wrapper type.
+ *
+ * Each thread repeatedly calls `with_lock` and records the time from the call
+ * until the function runs, i.e. the time spent acquiring the lock, in a
+ * `zdm::latency_histogram`. The report lists throughput and the p50, p99,
+ * p99.9 and maximum acquisition latency per wrapper type.
+ *
+ * Options:
+ * - `--threads=N`: worker threads, defaults to the number of allowed CPUs.
+ * - `--duration-ms=N`: run time per wrapper type, defaults to 1000.
+ * - `--hold-ns=N`: busy work inside the critical section, defaults to 100.
+ * - `--think-ns=N`: busy work between acquisitions, defaults to 0.
+ * - `--read-percent=N`: share of const `with_lock` calls, defaults to 0.
+ * - `--pin`: pin worker `i` to the `i`-th allowed CPU.
+ */
+#include "bench_common.hpp"
+#include <cstdint>
+#include <cstdio>
+
+int
+main(
+    int    argc,
+    char **argv
+)
+{
+    const zdm::bench::arguments arguments( argc, argv );
+    auto                        configuration
+        = zdm::bench::configuration_from( arguments );
+
+    if( arguments.flag( "pin" ) )
+    {
+        configuration.cpus = zdm::bench::allowed_cpus();
+    }
+
+    std::printf(
+        "%-24s %8s %14s %10s %10s %10s %12s\n",
+        "wrapper",
+        "threads",
+        "ops/s",
+        "p50 ns",
+        "p99 ns",
+        "p99.9 ns",
+        "max ns"
+    );
+
+    zdm::bench::for_each_wrapper_type<std::uint64_t>(
+        [&]<class AWrapper>( const char *a_name )
+        {
+            const auto measured
+                = zdm::bench::measure<AWrapper>( configuration );
+            const auto &latency = measured.latency;
+
+            std::printf(
+                "%-24s %8zu %14.0f %10llu %10llu %10llu %12llu\n",
+                a_name,
+                configuration.threads,
+                measured.operations_per_second(),
+                static_cast<unsigned long long>(
+                    latency.value_at_percentile( 50.0 )
+                ),
+                static_cast<unsigned long long>(
+                    latency.value_at_percentile( 99.0 )
+                ),
+                static_cast<unsigned long long>(
+                    latency.value_at_percentile( 99.9 )
+                ),
+                static_cast<unsigned long long>( latency.max() )
+            );
+        }
+    );
+
+    return 0;
+}
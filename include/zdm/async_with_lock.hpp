@@ -0,0 +1,599 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <zdm/lock_wrapper.hpp>
+#include <zdm/thread_pool.hpp>
+
+namespace zdm::concepts {
+
+/**
+ * @brief Concept for an executor that runs submitted tasks, such as
+ * `zdm::thread_pool` or `zdm::run_loop`.
+ */
+template <class AExecutor>
+concept executor
+    = requires( AExecutor &a_executor, std::function<void()> a_task ) {
+          a_executor.submit( std::move( a_task ) );
+      };
+
+/**
+ * @brief Concept for a receiver of a sender completing with `AValue`.
+ *
+ * The receiver is completed exactly once, through `set_value` with the
+ * result (no arguments for `void`) or through `set_error`.
+ */
+template <class AReceiver, class AValue>
+concept receiver_of
+    = requires( AReceiver &a_receiver, std::exception_ptr a_error ) {
+          a_receiver.set_error( std::move( a_error ) );
+      }
+   && ( ( std::is_void_v<AValue>
+          && requires( AReceiver &a_receiver ) { a_receiver.set_value(); } )
+        || ( !std::is_void_v<AValue>
+             && requires( AReceiver &a_receiver, AValue &&a_value ) {
+                    a_receiver.set_value( std::move( a_value ) );
+                } ) );
+
+} // namespace zdm::concepts
+
+namespace zdm {
+
+/**
+ * @brief A minimal single threaded executor.
+ *
+ * Tasks submitted from any thread are run by the thread calling `run`, which
+ * returns once `finish` has been called and the queue is empty.
+ */
+class run_loop
+{
+    public:
+        void
+        submit(
+            std::function<void()> a_task
+        )
+        {
+            // Notified under the lock: once the loop sees the task it may
+            // finish and be destroyed.
+            std::scoped_lock lock( m_mutex );
+            m_tasks.push_back( std::move( a_task ) );
+            m_condition.notify_one();
+        }
+
+        void
+        run()
+        {
+            for( ;; )
+            {
+                std::function<void()> task;
+
+                {
+                    std::unique_lock lock( m_mutex );
+                    m_condition.wait(
+                        lock,
+                        [this]()
+                        {
+                            return m_finishing || !m_tasks.empty();
+                        }
+                    );
+
+                    if( m_tasks.empty() )
+                    {
+                        return;
+                    }
+
+                    task = std::move( m_tasks.front() );
+                    m_tasks.pop_front();
+                }
+
+                task();
+            }
+        }
+
+        void
+        finish()
+        {
+            std::scoped_lock lock( m_mutex );
+            m_finishing = true;
+            m_condition.notify_all();
+        }
+
+    private:
+        std::mutex                        m_mutex;
+        std::condition_variable           m_condition;
+        std::deque<std::function<void()>> m_tasks;
+        bool                              m_finishing = false;
+};
+
+namespace detail {
+
+/**
+ * @brief The value an `async_with_lock` sender completes with: the result of
+ * the function, decayed so that references are copied under the lock.
+ */
+template <class AWrapper, class AFunction>
+using async_with_lock_value_t = std::remove_cvref_t<
+    decltype( std::declval<AWrapper &>().with_lock( std::declval<AFunction &>()
+    ) )>;
+
+/**
+ * @brief Submits delayed lock attempts from one background thread shared by
+ * every operation, so that waiting for a busy lock occupies no executor
+ * thread.
+ */
+class retry_timer
+{
+    public:
+        retry_timer()
+            : m_thread(
+                  [this]()
+                  {
+                      run();
+                  }
+              )
+        {
+        }
+
+        retry_timer( const retry_timer & )            = delete;
+        retry_timer &operator=( const retry_timer & ) = delete;
+
+        ~retry_timer()
+        {
+            {
+                std::scoped_lock lock( m_mutex );
+                m_stopping = true;
+            }
+
+            m_condition.notify_one();
+            m_thread.join();
+        }
+
+        static retry_timer &
+        shared()
+        {
+            static retry_timer s_timer;
+            return s_timer;
+        }
+
+        void
+        schedule(
+            std::chrono::steady_clock::duration a_delay,
+            std::function<void()>               a_task
+        )
+        {
+            {
+                std::scoped_lock lock( m_mutex );
+                m_tasks.emplace(
+                    std::chrono::steady_clock::now() + a_delay,
+                    std::move( a_task )
+                );
+            }
+
+            m_condition.notify_one();
+        }
+
+    private:
+        void
+        run()
+        {
+            std::unique_lock lock( m_mutex );
+
+            while( !m_stopping )
+            {
+                if( m_tasks.empty() )
+                {
+                    m_condition.wait( lock );
+                    continue;
+                }
+
+                const auto first = m_tasks.begin();
+
+                if( first->first > std::chrono::steady_clock::now() )
+                {
+                    m_condition.wait_until( lock, first->first );
+                    continue;
+                }
+
+                auto task = std::move( first->second );
+                m_tasks.erase( first );
+
+                lock.unlock();
+                task();
+                lock.lock();
+            }
+        }
+
+        std::mutex              m_mutex;
+        std::condition_variable m_condition;
+        std::multimap<
+            std::chrono::steady_clock::time_point,
+            std::function<void()>>
+                    m_tasks;
+        bool        m_stopping = false;
+        std::thread m_thread;
+};
+
+} // namespace detail
+
+/**
+ * @brief The operation state of `zdm::async_with_lock_sender`.
+ *
+ * Once started, every attempt runs on the executor and only tries the lock,
+ * so no executor thread ever blocks on the wrapper's mutex. The first
+ * attempts on a busy lock are resubmitted right away. After that, attempts
+ * back off exponentially, up to a millisecond apart, and wait on a shared
+ * timer thread rather than on the executor.
+ *
+ * A function returning a reference completes with a copy of the referenced
+ * object, made under the lock.
+ */
+template <class AExecutor, class AWrapper, class AFunction, class AReceiver>
+class async_with_lock_operation
+{
+    public:
+        using value_type = detail::async_with_lock_value_t<AWrapper, AFunction>;
+
+        async_with_lock_operation(
+            AExecutor &a_executor,
+            AWrapper  &a_wrapper,
+            AFunction  a_function,
+            AReceiver  a_receiver
+        )
+            : m_executor( a_executor )
+            , m_wrapper( a_wrapper )
+            , m_function( std::move( a_function ) )
+            , m_receiver( std::move( a_receiver ) )
+        {
+        }
+
+        async_with_lock_operation( const async_with_lock_operation & ) = delete;
+        async_with_lock_operation &
+        operator=( const async_with_lock_operation & ) = delete;
+
+        void
+        start() noexcept
+        {
+            submit_attempt();
+        }
+
+    private:
+        void
+        submit_attempt() noexcept
+        {
+            try
+            {
+                m_executor.submit(
+                    [this]()
+                    {
+                        attempt();
+                    }
+                );
+            }
+            catch( ... )
+            {
+                m_receiver.set_error( std::current_exception() );
+            }
+        }
+
+        /**
+         * @brief Tries the lock once. Only the attempt itself reports
+         * errors, so the receiver is never completed twice.
+         */
+        void
+        attempt() noexcept
+        {
+            using attempt_type
+                = decltype( m_wrapper.try_with_lock( m_function ) );
+
+            std::optional<attempt_type> result;
+
+            try
+            {
+                result.emplace( m_wrapper.try_with_lock( m_function ) );
+            }
+            catch( ... )
+            {
+                m_receiver.set_error( std::current_exception() );
+                return;
+            }
+
+            if( !*result )
+            {
+                retry();
+                return;
+            }
+
+            // A receiver whose `set_value` throws is completed with the
+            // exception instead, as senders do.
+            try
+            {
+                if constexpr( std::is_void_v<value_type> )
+                {
+                    m_receiver.set_value();
+                }
+                else
+                {
+                    m_receiver.set_value( std::move( **result ) );
+                }
+            }
+            catch( ... )
+            {
+                m_receiver.set_error( std::current_exception() );
+            }
+        }
+
+        void
+        retry() noexcept
+        {
+            if( m_immediate_retries < immediate_retries )
+            {
+                ++m_immediate_retries;
+                submit_attempt();
+                return;
+            }
+
+            m_delay = std::clamp( m_delay * 2, min_delay, max_delay );
+
+            try
+            {
+                detail::retry_timer::shared().schedule(
+                    m_delay,
+                    [this]()
+                    {
+                        submit_attempt();
+                    }
+                );
+            }
+            catch( ... )
+            {
+                m_receiver.set_error( std::current_exception() );
+            }
+        }
+
+        static constexpr std::size_t immediate_retries = 4;
+        static constexpr std::chrono::microseconds min_delay{ 16 };
+        static constexpr std::chrono::microseconds max_delay{ 1000 };
+
+        AExecutor                &m_executor;
+        AWrapper                 &m_wrapper;
+        AFunction                 m_function;
+        AReceiver                 m_receiver;
+        std::size_t               m_immediate_retries = 0;
+        std::chrono::microseconds m_delay{ 0 };
+};
+
+/**
+ * @brief A sender completing with the result of running a function under a
+ * wrapper's lock.
+ *
+ * Created by `zdm::async_with_lock`. Mutable wrappers take the unique lock
+ * and const wrappers the shared lock, following the `with_lock` overloads.
+ */
+template <class AExecutor, class AWrapper, class AFunction>
+class async_with_lock_sender
+{
+    public:
+        using value_type = detail::async_with_lock_value_t<AWrapper, AFunction>;
+
+        async_with_lock_sender(
+            AExecutor &a_executor,
+            AWrapper  &a_wrapper,
+            AFunction  a_function
+        )
+            : m_executor( a_executor )
+            , m_wrapper( a_wrapper )
+            , m_function( std::move( a_function ) )
+        {
+        }
+
+        /**
+         * @brief Connects the sender to a receiver.
+         *
+         * The returned operation state must stay alive, and must not be
+         * moved, until the receiver has been completed.
+         */
+        template <concepts::receiver_of<value_type> AReceiver>
+        auto
+        connect(
+            AReceiver a_receiver
+        ) &&
+        {
+            return async_with_lock_operation<
+                AExecutor,
+                AWrapper,
+                AFunction,
+                AReceiver>(
+                m_executor,
+                m_wrapper,
+                std::move( m_function ),
+                std::move( a_receiver )
+            );
+        }
+
+    private:
+        AExecutor &m_executor;
+        AWrapper  &m_wrapper;
+        AFunction  m_function;
+};
+
+/**
+ * @brief Creates a sender that runs a function under the wrapper's lock on an
+ * executor.
+ *
+ * @param a_executor The executor running the lock attempts and the function.
+ * @param a_wrapper The wrapper to lock. It must outlive the operation.
+ * @param a_function A callable accepted by the wrapper's `try_with_lock`.
+ * @return A sender completing with the result of the function.
+ */
+template <concepts::executor AExecutor, class AWrapper, class AFunction>
+auto
+async_with_lock(
+    AExecutor  &a_executor,
+    AWrapper   &a_wrapper,
+    AFunction &&a_function
+)
+{
+    return async_with_lock_sender<
+        AExecutor,
+        AWrapper,
+        std::decay_t<AFunction>>(
+        a_executor,
+        a_wrapper,
+        std::forward<AFunction>( a_function )
+    );
+}
+
+/**
+ * @brief Creates a sender that runs a function under the wrapper's lock on
+ * `zdm::thread_pool::shared()`.
+ */
+template <class AWrapper, class AFunction>
+auto
+async_with_lock(
+    AWrapper   &a_wrapper,
+    AFunction &&a_function
+)
+{
+    return async_with_lock(
+        thread_pool::shared(),
+        a_wrapper,
+        std::forward<AFunction>( a_function )
+    );
+}
+
+namespace detail {
+
+template <class AValue>
+struct sync_wait_state
+{
+        std::mutex              m_mutex;
+        std::condition_variable m_condition;
+        bool                    m_done = false;
+        std::optional<AValue>   m_value;
+        std::exception_ptr      m_error;
+};
+
+template <>
+struct sync_wait_state<void>
+{
+        std::mutex              m_mutex;
+        std::condition_variable m_condition;
+        bool                    m_done = false;
+        std::exception_ptr      m_error;
+};
+
+template <class AValue>
+struct sync_wait_receiver
+{
+        sync_wait_state<AValue> *m_state;
+
+        template <class... AValues>
+        void
+        set_value(
+            AValues &&...a_values
+        )
+        {
+            std::scoped_lock lock( m_state->m_mutex );
+
+            if constexpr( sizeof...( AValues ) != 0 )
+            {
+                m_state->m_value.emplace( std::forward<AValues>( a_values )...
+                );
+            }
+
+            m_state->m_done = true;
+            m_state->m_condition.notify_all();
+        }
+
+        void
+        set_error(
+            std::exception_ptr a_error
+        )
+        {
+            std::scoped_lock lock( m_state->m_mutex );
+            m_state->m_error = std::move( a_error );
+            m_state->m_done  = true;
+            m_state->m_condition.notify_all();
+        }
+};
+
+} // namespace detail
+
+/**
+ * @brief Starts a sender and blocks the calling thread until it completes.
+ *
+ * Meant for tests and for the edges of an asynchronous program. The sender's
+ * executor must be driven by other threads.
+ *
+ * @return The value the sender completed with. An error is rethrown.
+ */
+template <class ASender>
+auto
+sync_wait(
+    ASender &&a_sender
+) -> typename std::remove_cvref_t<ASender>::value_type
+{
+    using value_type = typename std::remove_cvref_t<ASender>::value_type;
+
+    detail::sync_wait_state<value_type> state;
+    auto                                operation
+        = std::move( a_sender ).connect(
+            detail::sync_wait_receiver<value_type>{ &state }
+        );
+
+    operation.start();
+
+    std::unique_lock lock( state.m_mutex );
+    state.m_condition.wait(
+        lock,
+        [&state]()
+        {
+            return state.m_done;
+        }
+    );
+
+    if( state.m_error )
+    {
+        std::rethrow_exception( state.m_error );
+    }
+
+    if constexpr( !std::is_void_v<value_type> )
+    {
+        return std::move( *state.m_value );
+    }
+}
+
+} // namespace zdm
@@ -0,0 +1,165 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <zdm/cow_wrapper.hpp>
+#include <zdm/detail/replace_file.hpp>
+#include <zdm/lock_wrapper.hpp>
+#include <zdm/thread_pool.hpp>
+
+namespace zdm::detail {
+
+/**
+ * @brief Serializes a value to a file through `zdm::detail::replace_file`,
+ * so readers never see a partial checkpoint.
+ */
+template <class T, class ASerializer>
+bool
+write_checkpoint(
+    const std::filesystem::path &a_path,
+    const T                     &a_value,
+    ASerializer                 &a_serializer
+)
+{
+    return replace_file(
+        a_path,
+        std::ios::binary,
+        [&]( std::ofstream& a_stream )
+        {
+            a_serializer( a_stream, a_value );
+        }
+    );
+}
+
+/**
+ * @brief Writes a snapshot on `a_pool`.
+ */
+template <class T, class ASerializer>
+std::future<bool>
+write_checkpoint_async(
+    std::shared_ptr<const T> a_snapshot,
+    std::filesystem::path    a_path,
+    ASerializer              a_serializer,
+    thread_pool             &a_pool
+)
+{
+    auto promise = std::make_shared<std::promise<bool>>();
+    auto written = promise->get_future();
+
+    a_pool.submit(
+        [promise,
+         snapshot   = std::move( a_snapshot ),
+         path       = std::move( a_path ),
+         serializer = std::move( a_serializer )]() mutable
+        {
+            try
+            {
+                promise->set_value(
+                    write_checkpoint( path, *snapshot, serializer )
+                );
+            }
+            catch( ... )
+            {
+                promise->set_exception( std::current_exception() );
+            }
+        }
+    );
+
+    return written;
+}
+
+} // namespace zdm::detail
+
+namespace zdm {
+
+/**
+ * @brief Writes the contents of a wrapper to a file in the background.
+ *
+ * The lock is only held to take a snapshot, which shares the contained
+ * object instead of copying it. The snapshot is then serialized on
+ * `a_pool`, into a temporary file that replaces `a_path` once complete. The
+ * file is not synced to disk before it does.
+ *
+ * @param a_serializer Called as `a_serializer( stream, value )` with a
+ * binary `std::ostream`. Must be copyable.
+ * @return Whether the file was written. Holds the serializer's exception if
+ * it threw.
+ */
+template <class T, class AMutex, class ASerializer>
+std::future<bool>
+checkpoint(
+    const basic_cow_wrapper<T, AMutex> &a_wrapper,
+    std::filesystem::path               a_path,
+    ASerializer                         a_serializer,
+    thread_pool                        &a_pool = thread_pool::shared()
+)
+{
+    return detail::write_checkpoint_async(
+        a_wrapper.snapshot(),
+        std::move( a_path ),
+        std::move( a_serializer ),
+        a_pool
+    );
+}
+
+/**
+ * @brief Writes the contents of a wrapper to a file in the background.
+ *
+ * The contained object is copied under the lock, which is still much
+ * shorter than serializing it there. Use a `zdm::basic_cow_wrapper` to avoid
+ * the copy.
+ *
+ * Takes the same arguments as the `basic_cow_wrapper` overload.
+ */
+template <class T, class AMutex, class ASerializer>
+std::future<bool>
+checkpoint(
+    const basic_lock_wrapper<T, AMutex> &a_wrapper,
+    std::filesystem::path                a_path,
+    ASerializer                          a_serializer,
+    thread_pool                         &a_pool = thread_pool::shared()
+)
+{
+    auto snapshot = a_wrapper.with_lock(
+        []( const T& a_value )
+        {
+            return std::make_shared<const T>( a_value );
+        }
+    );
+
+    return detail::write_checkpoint_async(
+        std::shared_ptr<const T>( std::move( snapshot ) ),
+        std::move( a_path ),
+        std::move( a_serializer ),
+        a_pool
+    );
+}
+
+} // namespace zdm
@@ -0,0 +1,382 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <zdm/lock_trace.hpp>
+
+namespace zdm::detail {
+
+inline void
+write_json_string(
+    std::ostream    &a_stream,
+    std::string_view a_text
+)
+{
+    a_stream << '"';
+
+    for( const char character : a_text )
+    {
+        switch( character )
+        {
+        case '"':
+            a_stream << "\\\"";
+            break;
+        case '\\':
+            a_stream << "\\\\";
+            break;
+        case '\n':
+            a_stream << "\\n";
+            break;
+        case '\t':
+            a_stream << "\\t";
+            break;
+        default:
+            if( static_cast<unsigned char>( character ) < 0x20 )
+            {
+                char escaped[8];
+                std::snprintf(
+                    escaped,
+                    sizeof( escaped ),
+                    "\\u%04x",
+                    static_cast<unsigned>( character )
+                );
+                a_stream << escaped;
+            }
+            else
+            {
+                a_stream << character;
+            }
+        }
+    }
+
+    a_stream << '"';
+}
+
+/**
+ * @brief Writes nanoseconds as the microseconds used by the trace event
+ * format, keeping nanosecond precision.
+ */
+inline void
+write_trace_microseconds(
+    std::ostream &a_stream,
+    std::uint64_t a_ns
+)
+{
+    char text[32];
+    std::snprintf(
+        text,
+        sizeof( text ),
+        "%llu.%03llu",
+        static_cast<unsigned long long>( a_ns / 1000 ),
+        static_cast<unsigned long long>( a_ns % 1000 )
+    );
+    a_stream << text;
+}
+
+/**
+ * @brief Emits the individual records of a Chrome trace, taking care of the
+ * separators and of making timestamps relative to the first event.
+ */
+class chrome_trace_writer
+{
+    public:
+        chrome_trace_writer(
+            std::ostream &a_stream,
+            std::uint64_t a_origin_ns
+        )
+            : m_stream( a_stream )
+            , m_origin_ns( a_origin_ns )
+        {
+        }
+
+        void
+        metadata(
+            int              a_process,
+            std::uint32_t    a_thread,
+            const char      *a_kind,
+            std::string_view a_name
+        )
+        {
+            begin();
+            m_stream << R"({"ph":"M","pid":)" << a_process << R"(,"tid":)"
+                     << a_thread << R"(,"name":")" << a_kind
+                     << R"(","args":{"name":)";
+            write_json_string( m_stream, a_name );
+            m_stream << "}}";
+        }
+
+        void
+        slice(
+            int                                a_process,
+            std::uint32_t                      a_thread,
+            const char                        *a_category,
+            std::string_view                   a_name,
+            std::uint64_t                      a_start_ns,
+            std::uint64_t                      a_duration_ns,
+            const instrumentation::lock_event &a_event
+        )
+        {
+            record( "X", a_process, a_thread, a_category, a_name );
+            m_stream << R"(,"ts":)";
+            write_trace_microseconds( m_stream, a_start_ns - m_origin_ns );
+            m_stream << R"(,"dur":)";
+            write_trace_microseconds( m_stream, a_duration_ns );
+            arguments( a_event );
+        }
+
+        /**
+         * @brief A slice that may overlap others of the same track, written
+         * as a begin and end pair of async events matched by `a_id`.
+         */
+        void
+        async_slice(
+            int                                a_process,
+            std::uint32_t                      a_thread,
+            const char                        *a_category,
+            std::string_view                   a_name,
+            std::string_view                   a_id,
+            std::uint64_t                      a_start_ns,
+            std::uint64_t                      a_duration_ns,
+            const instrumentation::lock_event &a_event
+        )
+        {
+            record( "b", a_process, a_thread, a_category, a_name );
+            m_stream << R"(,"id":)";
+            write_json_string( m_stream, a_id );
+            m_stream << R"(,"ts":)";
+            write_trace_microseconds( m_stream, a_start_ns - m_origin_ns );
+            arguments( a_event );
+
+            record( "e", a_process, a_thread, a_category, a_name );
+            m_stream << R"(,"id":)";
+            write_json_string( m_stream, a_id );
+            m_stream << R"(,"ts":)";
+            write_trace_microseconds(
+                m_stream,
+                a_start_ns + a_duration_ns - m_origin_ns
+            );
+            m_stream << '}';
+        }
+
+    private:
+        void
+        begin()
+        {
+            m_stream << ( m_first ? "\n" : ",\n" );
+            m_first = false;
+        }
+
+        void
+        record(
+            const char      *a_phase,
+            int              a_process,
+            std::uint32_t    a_thread,
+            const char      *a_category,
+            std::string_view a_name
+        )
+        {
+            begin();
+            m_stream << R"({"ph":")" << a_phase << R"(","pid":)" << a_process
+                     << R"(,"tid":)" << a_thread << R"(,"cat":")"
+                     << a_category << R"(","name":)";
+            write_json_string( m_stream, a_name );
+        }
+
+        void
+        arguments(
+            const instrumentation::lock_event &a_event
+        )
+        {
+            const bool shared
+                = a_event.mode == instrumentation::lock_mode::shared;
+
+            m_stream << R"(,"args":{"wrapper":)" << a_event.wrapper
+                     << R"(,"thread":)" << a_event.thread << R"(,"mode":")"
+                     << ( shared ? "shared" : "exclusive" )
+                     << R"(","contended":)"
+                     << ( a_event.contended ? "true" : "false" ) << "}}";
+        }
+
+        std::ostream &m_stream;
+        std::uint64_t m_origin_ns;
+        bool          m_first = true;
+};
+
+} // namespace zdm::detail
+
+namespace zdm::instrumentation {
+
+/**
+ * @brief Writes a lock trace in the Chrome Trace Event JSON format, as read
+ * by Perfetto and `chrome://tracing`.
+ *
+ * The "threads" process has one track per recorded thread, showing when it
+ * waited for and held which wrapper. The "wrappers" process has one track
+ * per wrapper, showing its exclusive critical sections back to back, which
+ * makes convoys easy to spot. Shared holds can overlap, so they are written
+ * as async slices with one id per wrapper and holder, which viewers stack on
+ * tracks of their own. Slices are named after the wrappers; unnamed wrappers
+ * are shown as `wrapper <id>`. Times are relative to the earliest event, and
+ * the events do not need to be sorted.
+ */
+inline void
+write_chrome_trace(
+    std::ostream     &a_stream,
+    const lock_trace &a_trace
+)
+{
+    constexpr int threads_process  = 1;
+    constexpr int wrappers_process = 2;
+
+    std::unordered_map<std::uint32_t, std::string> names;
+
+    for( const auto &[id, name] : a_trace.wrappers )
+    {
+        if( !name.empty() )
+        {
+            names.emplace( id, name );
+        }
+    }
+
+    std::vector<const lock_event *> events;
+    events.reserve( a_trace.events.size() );
+
+    for( const auto &event : a_trace.events )
+    {
+        events.push_back( &event );
+    }
+
+    std::ranges::stable_sort(
+        events,
+        {},
+        []( const lock_event* a_event )
+        {
+            return a_event->start_ns;
+        }
+    );
+
+    const auto origin_ns = events.empty() ? 0 : events.front()->start_ns;
+    zdm::detail::chrome_trace_writer writer( a_stream, origin_ns );
+
+    std::unordered_set<std::uint32_t> threads;
+    std::unordered_set<std::uint32_t> wrappers;
+
+    a_stream << R"({"displayTimeUnit":"ns","traceEvents":[)";
+
+    writer.metadata( threads_process, 0, "process_name", "threads" );
+    writer.metadata( wrappers_process, 0, "process_name", "wrappers" );
+
+    for( const auto *pointer : events )
+    {
+        const auto &event  = *pointer;
+        const auto  found  = names.find( event.wrapper );
+        const auto  name   = found != names.end()
+                               ? found->second
+                               : "wrapper " + std::to_string( event.wrapper );
+        const auto  thread = "thread " + std::to_string( event.thread );
+        const auto  held   = event.start_ns + event.wait_ns;
+
+        if( threads.insert( event.thread ).second )
+        {
+            writer.metadata(
+                threads_process,
+                event.thread,
+                "thread_name",
+                thread
+            );
+        }
+
+        if( wrappers.insert( event.wrapper ).second )
+        {
+            writer.metadata(
+                wrappers_process,
+                event.wrapper,
+                "thread_name",
+                name
+            );
+        }
+
+        if( event.wait_ns != 0 )
+        {
+            writer.slice(
+                threads_process,
+                event.thread,
+                "lock.wait",
+                "wait " + name,
+                event.start_ns,
+                event.wait_ns,
+                event
+            );
+        }
+
+        writer.slice(
+            threads_process,
+            event.thread,
+            "lock.hold",
+            "hold " + name,
+            held,
+            event.hold_ns,
+            event
+        );
+
+        if( event.mode == lock_mode::shared )
+        {
+            writer.async_slice(
+                wrappers_process,
+                event.wrapper,
+                "lock.hold",
+                thread,
+                std::to_string( event.wrapper ) + ":"
+                    + std::to_string( event.thread ),
+                held,
+                event.hold_ns,
+                event
+            );
+        }
+        else
+        {
+            writer.slice(
+                wrappers_process,
+                event.wrapper,
+                "lock.hold",
+                thread,
+                held,
+                event.hold_ns,
+                event
+            );
+        }
+    }
+
+    a_stream << "\n]}\n";
+}
+
+} // namespace zdm::instrumentation
@@ -0,0 +1,360 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <zdm/lock_wrapper.hpp>
+
+namespace zdm {
+
+/**
+ * @brief An append-only vector whose published elements can be read without
+ * locking.
+ *
+ * Elements live in segments whose sizes double, so appending never moves an
+ * element: existing references stay valid and readers are never blocked by
+ * a reallocation. Appends are serialized by a lock held only to construct the
+ * new element (and allocate a segment when one fills up). An element is
+ * published, through `size()`, once it is fully constructed, and can then be
+ * read from any thread without a lock.
+ *
+ * Published elements are only exposed as const. They are destroyed with the
+ * vector.
+ */
+template <class T>
+class concurrent_append_vector
+{
+    private:
+        static constexpr unsigned    first_segment_bits = 4;
+        static constexpr std::size_t segment_count
+            = sizeof( std::size_t ) * 8 - first_segment_bits;
+
+        struct location
+        {
+                std::size_t segment;
+                std::size_t offset;
+        };
+
+    public:
+        using value_type      = T;
+        using size_type       = std::size_t;
+        using const_reference = const T &;
+
+        class const_iterator
+        {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type        = T;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = const T *;
+                using reference         = const T &;
+
+                const_iterator() = default;
+
+                const_iterator(
+                    const concurrent_append_vector *a_vector,
+                    std::size_t                     a_index
+                ) noexcept
+                    : m_vector( a_vector )
+                    , m_index( a_index )
+                {
+                }
+
+                reference
+                operator*() const noexcept
+                {
+                    return ( *m_vector )[m_index];
+                }
+
+                pointer
+                operator->() const noexcept
+                {
+                    return &( *m_vector )[m_index];
+                }
+
+                const_iterator &
+                operator++() noexcept
+                {
+                    ++m_index;
+                    return *this;
+                }
+
+                const_iterator
+                operator++( int ) noexcept
+                {
+                    auto previous = *this;
+                    ++m_index;
+                    return previous;
+                }
+
+                friend bool
+                operator==(
+                    const const_iterator &a_left,
+                    const const_iterator &a_right
+                ) noexcept
+                {
+                    return a_left.m_index == a_right.m_index;
+                }
+
+            private:
+                const concurrent_append_vector *m_vector = nullptr;
+                std::size_t                     m_index  = 0;
+        };
+
+        concurrent_append_vector() = default;
+
+        concurrent_append_vector( const concurrent_append_vector & ) = delete;
+        concurrent_append_vector &
+        operator=( const concurrent_append_vector & ) = delete;
+
+        ~concurrent_append_vector()
+        {
+            const auto size = m_size.load( std::memory_order_relaxed );
+
+            for( std::size_t i = 0; i < size; ++i )
+            {
+                std::destroy_at( &( *this )[i] );
+            }
+
+            for( std::size_t segment = 0; segment < segment_count; ++segment )
+            {
+                if( auto *storage
+                    = m_segments[segment].load( std::memory_order_relaxed ) )
+                {
+                    std::allocator<T>().deallocate(
+                        storage,
+                        segment_size( segment )
+                    );
+                }
+            }
+        }
+
+        /**
+         * @brief Appends an element constructed from `a_arguments`.
+         *
+         * @return The index of the new element.
+         */
+        template <class... AArguments>
+        std::size_t
+        emplace_back(
+            AArguments &&...a_arguments
+        )
+        {
+            return m_appending.with_lock(
+                [&]( std::size_t& a_size )
+                {
+                    const auto index = a_size;
+                    const auto place = locate( index );
+
+                    if( place.segment >= segment_count )
+                    {
+                        throw std::length_error(
+                            "concurrent_append_vector::emplace_back"
+                        );
+                    }
+
+                    std::construct_at(
+                        allocated_segment( place.segment ) + place.offset,
+                        std::forward<AArguments>( a_arguments )...
+                    );
+                    m_size.store( ++a_size, std::memory_order_release );
+                    return index;
+                }
+            );
+        }
+
+        std::size_t
+        push_back(
+            const T &a_value
+        )
+        {
+            return emplace_back( a_value );
+        }
+
+        std::size_t
+        push_back(
+            T &&a_value
+        )
+        {
+            return emplace_back( std::move( a_value ) );
+        }
+
+        /**
+         * @brief Allocates the segments holding the first `a_capacity`
+         * elements, so that appending them does not allocate.
+         */
+        void
+        reserve(
+            std::size_t a_capacity
+        )
+        {
+            if( a_capacity == 0 )
+            {
+                return;
+            }
+
+            m_appending.with_lock(
+                [&]( std::size_t& )
+                {
+                    const auto last = locate( a_capacity - 1 ).segment;
+
+                    if( last >= segment_count )
+                    {
+                        throw std::length_error(
+                            "concurrent_append_vector::reserve"
+                        );
+                    }
+
+                    for( std::size_t segment = 0; segment <= last; ++segment )
+                    {
+                        allocated_segment( segment );
+                    }
+                }
+            );
+        }
+
+        /**
+         * @brief The number of published elements. Never decreases.
+         */
+        std::size_t
+        size() const noexcept
+        {
+            return m_size.load( std::memory_order_acquire );
+        }
+
+        bool
+        empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        /**
+         * @brief A published element. `a_index` must be below a value
+         * returned by `size()` or `push_back`.
+         */
+        const T &
+        operator[](
+            std::size_t a_index
+        ) const noexcept
+        {
+            const auto place = locate( a_index );
+            return m_segments[place.segment].load( std::memory_order_acquire )
+                [place.offset];
+        }
+
+        const T &
+        at(
+            std::size_t a_index
+        ) const
+        {
+            if( a_index >= size() )
+            {
+                throw std::out_of_range( "concurrent_append_vector::at" );
+            }
+
+            return ( *this )[a_index];
+        }
+
+        /**
+         * @brief Iterates over the elements published when `end()` is
+         * called.
+         */
+        const_iterator
+        begin() const noexcept
+        {
+            return { this, 0 };
+        }
+
+        const_iterator
+        end() const noexcept
+        {
+            return { this, size() };
+        }
+
+    private:
+        static constexpr std::size_t
+        segment_size(
+            std::size_t a_segment
+        ) noexcept
+        {
+            return std::size_t{ 1 } << ( a_segment + first_segment_bits );
+        }
+
+        /**
+         * @brief Segment `s` holds the indices from `2^(s + b) - 2^b` on,
+         * where `b` is `first_segment_bits`. The last `2^b` indices wrap
+         * around and map to segments past `segment_count`.
+         */
+        static constexpr location
+        locate(
+            std::size_t a_index
+        ) noexcept
+        {
+            const auto biased  = a_index + segment_size( 0 );
+            const auto segment = static_cast<std::size_t>(
+                std::bit_width( biased ) - 1 - first_segment_bits
+            );
+            return { segment, biased - segment_size( segment ) };
+        }
+
+        /**
+         * @brief The storage of a segment, allocated on first use. Called
+         * with `m_appending` locked.
+         */
+        T *
+        allocated_segment(
+            std::size_t a_segment
+        )
+        {
+            auto *storage
+                = m_segments[a_segment].load( std::memory_order_relaxed );
+
+            if( storage == nullptr )
+            {
+                storage
+                    = std::allocator<T>().allocate( segment_size( a_segment ) );
+                m_segments[a_segment].store(
+                    storage,
+                    std::memory_order_release
+                );
+            }
+
+            return storage;
+        }
+
+        std::array<std::atomic<T *>, segment_count> m_segments{};
+        std::atomic<std::size_t>                     m_size{ 0 };
+        /** @brief The number of constructed elements, for appending. */
+        zdm::lock_wrapper<std::size_t>               m_appending{
+            std::size_t{ 0 }
+        };
+};
+
+} // namespace zdm
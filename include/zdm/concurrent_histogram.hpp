@@ -0,0 +1,218 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <zdm/detail/thread_local_cache.hpp>
+#include <zdm/latency_histogram.hpp>
+#include <zdm/lock_wrapper.hpp>
+
+namespace zdm::detail {
+
+/**
+ * @brief The buckets one thread records into. Only the owning thread writes,
+ * so updates are plain relaxed loads and stores, never read-modify-writes.
+ */
+struct histogram_shard
+{
+        std::array<std::atomic<std::uint64_t>, latency_histogram::bucket_count>
+                                   buckets{};
+        std::atomic<std::uint64_t> sum{ 0 };
+        std::atomic<std::uint64_t> min{
+            std::numeric_limits<std::uint64_t>::max()
+        };
+        std::atomic<std::uint64_t> max{ 0 };
+
+        static void
+        store(
+            std::atomic<std::uint64_t> &a_counter,
+            std::uint64_t               a_value
+        ) noexcept
+        {
+            a_counter.store( a_value, std::memory_order_relaxed );
+        }
+
+        static std::uint64_t
+        load(
+            const std::atomic<std::uint64_t> &a_counter
+        ) noexcept
+        {
+            return a_counter.load( std::memory_order_relaxed );
+        }
+
+        void
+        record(
+            std::uint64_t a_value,
+            std::uint64_t a_count
+        ) noexcept
+        {
+            auto &bucket = buckets[latency_histogram::bucket_index( a_value )];
+
+            store( bucket, load( bucket ) + a_count );
+            store( sum, load( sum ) + a_value * a_count );
+
+            if( a_value < load( min ) )
+            {
+                store( min, a_value );
+            }
+
+            if( a_value > load( max ) )
+            {
+                store( max, a_value );
+            }
+        }
+};
+
+} // namespace zdm::detail
+
+namespace zdm {
+
+/**
+ * @brief A latency histogram that any number of threads record into without
+ * locking.
+ *
+ * Every thread records into buckets of its own, created on its first
+ * `record`. Reads merge the buckets of every thread into a
+ * `zdm::latency_histogram` snapshot. Recording never waits for a reader, and
+ * readers only lock the list of threads.
+ *
+ * A snapshot taken while threads record may miss their latest values, but
+ * its buckets always add up to its count.
+ */
+class concurrent_histogram
+{
+    public:
+        concurrent_histogram() = default;
+
+        concurrent_histogram( const concurrent_histogram & ) = delete;
+        concurrent_histogram &
+        operator=( const concurrent_histogram & ) = delete;
+
+        void
+        record(
+            std::uint64_t a_value,
+            std::uint64_t a_count = 1
+        )
+        {
+            local_shard().record( a_value, a_count );
+        }
+
+        /**
+         * @brief The values recorded by every thread so far.
+         */
+        latency_histogram
+        snapshot() const
+        {
+            latency_histogram merged;
+
+            m_shards.with_lock(
+                [&merged]( const shard_list& a_shards )
+                {
+                    using shard = detail::histogram_shard;
+
+                    for( const auto &local : a_shards )
+                    {
+                        for( std::size_t i = 0;
+                             i < latency_histogram::bucket_count;
+                             ++i )
+                        {
+                            const auto count = shard::load( local->buckets[i] );
+
+                            merged.m_buckets[i] += count;
+                            merged.m_count += count;
+                        }
+
+                        merged.m_sum += shard::load( local->sum );
+                        merged.m_min = std::min(
+                            merged.m_min,
+                            shard::load( local->min )
+                        );
+                        merged.m_max = std::max(
+                            merged.m_max,
+                            shard::load( local->max )
+                        );
+                    }
+                }
+            );
+
+            return merged;
+        }
+
+        /**
+         * @brief Executes a function on a snapshot, as the const `with_lock`
+         * of a `zdm::lock_wrapper<zdm::latency_histogram>` would.
+         *
+         * @return The result of the function.
+         */
+        inline auto
+        with_lock(
+            concepts::unary_const_reference_function<latency_histogram> auto
+                &&a_function
+        ) const
+            -> decltype( a_function( std::declval<const latency_histogram &>()
+            ) )
+        {
+            const auto merged = snapshot();
+            return a_function( merged );
+        }
+
+    private:
+        using shard_list
+            = std::vector<std::unique_ptr<detail::histogram_shard>>;
+
+        /**
+         * @brief The calling thread's shard, created on its first record.
+         */
+        detail::histogram_shard &
+        local_shard()
+        {
+            return m_local.local(
+                [this]()
+                {
+                    return m_shards.with_lock(
+                        []( shard_list& a_shards )
+                        {
+                            return a_shards
+                                .emplace_back(
+                                    std::make_unique<detail::histogram_shard>()
+                                )
+                                .get();
+                        }
+                    );
+                }
+            );
+        }
+
+        detail::thread_local_cache<detail::histogram_shard> m_local;
+        zdm::lock_wrapper<shard_list>                       m_shards;
+};
+
+} // namespace zdm
@@ -0,0 +1,389 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <zdm/detail/current_cpu.hpp>
+#include <zdm/instrumented_mutex.hpp>
+#include <zdm/lock_wrapper.hpp>
+
+namespace zdm::instrumentation {
+
+/**
+ * @brief How a wrapper's lock is handed from thread to thread, as measured
+ * by a `zdm::instrumentation::convoy_detector`.
+ */
+struct convoy_stats
+{
+        std::uint32_t wrapper = 0;
+        /** @brief The wrapper's name, or an empty string. */
+        std::string   name;
+        /** @brief Exclusive acquisitions. */
+        std::uint64_t acquisitions = 0;
+        /** @brief Contended acquisitions following another thread's hold. */
+        std::uint64_t contended_handoffs = 0;
+        /** @brief Handoffs that moved the lock to another CPU. */
+        std::uint64_t migrations = 0;
+        /** @brief Acquisitions that were part of a convoy. */
+        std::uint64_t convoy_acquisitions = 0;
+        /** @brief The longest chain of consecutive contended handoffs. */
+        std::uint64_t longest_chain = 0;
+
+        /**
+         * @brief The share of acquisitions that were part of a convoy, from 0
+         * to 1.
+         */
+        double
+        convoy_score() const noexcept
+        {
+            return acquisitions == 0
+                     ? 0.0
+                     : static_cast<double>( convoy_acquisitions )
+                           / static_cast<double>( acquisitions );
+        }
+
+        /**
+         * @brief The share of contended handoffs that moved the lock to
+         * another CPU, from 0 to 1. High values with short holds point to a
+         * handoff storm.
+         */
+        double
+        migration_ratio() const noexcept
+        {
+            return contended_handoffs == 0
+                     ? 0.0
+                     : static_cast<double>( migrations )
+                           / static_cast<double>( contended_handoffs );
+        }
+};
+
+} // namespace zdm::instrumentation
+
+namespace zdm::detail {
+
+/**
+ * @brief A release waiting to be put back in acquisition order.
+ */
+struct convoy_release
+{
+        instrumentation::lock_event event;
+        int                         cpu;
+
+        std::uint64_t
+        acquired_ns() const noexcept
+        {
+            return event.start_ns + event.wait_ns;
+        }
+};
+
+struct convoy_state
+{
+        instrumentation::convoy_stats stats;
+        std::uint32_t                 last_thread = 0;
+        int                           last_cpu    = -1;
+        std::uint64_t                 chain       = 0;
+        /** @brief Recent releases, oldest acquisition first. */
+        std::vector<convoy_release>   pending;
+};
+
+} // namespace zdm::detail
+
+namespace zdm::instrumentation {
+
+/**
+ * @brief Detects lock convoys and handoff storms on instrumented wrappers
+ * while started.
+ *
+ * A convoy forms when a lock is handed directly from one waiting thread to
+ * the next: every acquisition is contended, so throughput drops to one
+ * critical section per wake up and average wait times hide the cause. The
+ * detector follows the exclusive acquisitions of every wrapper and counts
+ * chains of consecutive contended handoffs between threads. Chains of at
+ * least `a_convoy_length` handoffs are convoys, and the share of
+ * acquisitions that were part of one is the wrapper's convoy score. Handoffs
+ * that move the lock to another CPU are counted as migrations.
+ *
+ * Observers see releases in the order their threads got around to reporting
+ * them, which is not always the order the lock was acquired in. The
+ * detector holds back the last `reorder_window` releases of every wrapper
+ * and follows them in order of acquisition, `start_ns + wait_ns`. Releases
+ * reported later than that are followed as they come.
+ *
+ * The CPU is sampled when the lock is released, on Linux only; elsewhere
+ * handoffs between threads count as migrations.
+ */
+class convoy_detector : public observer
+{
+    public:
+        /**
+         * @brief The number of releases per wrapper held back to be put in
+         * acquisition order.
+         */
+        static constexpr std::size_t reorder_window = 16;
+
+        explicit convoy_detector(
+            std::uint64_t a_convoy_length = 8
+        )
+            : m_convoy_length( std::max<std::uint64_t>( a_convoy_length, 1 ) )
+        {
+        }
+
+        convoy_detector( const convoy_detector & )            = delete;
+        convoy_detector &operator=( const convoy_detector & ) = delete;
+
+        ~convoy_detector() override
+        {
+            stop();
+        }
+
+        void
+        start()
+        {
+            if( !m_started.exchange( true ) )
+            {
+                add_observer( *this );
+            }
+        }
+
+        void
+        stop()
+        {
+            if( m_started.exchange( false ) )
+            {
+                remove_observer( *this );
+            }
+        }
+
+        /**
+         * @brief The statistics of every wrapper seen so far, highest convoy
+         * score first.
+         */
+        std::vector<convoy_stats>
+        stats() const
+        {
+            std::vector<convoy_stats> result;
+
+            for( const auto &stripe : m_stripes )
+            {
+                stripe.with_lock(
+                    [this, &result]( const stripe_map& a_states )
+                    {
+                        for( const auto &[id, state] : a_states )
+                        {
+                            result.push_back( flushed( state ) );
+                        }
+                    }
+                );
+            }
+
+            for( auto &stats : result )
+            {
+                stats.name = wrapper_name( stats.wrapper );
+            }
+
+            std::ranges::sort(
+                result,
+                []( const convoy_stats& a_left, const convoy_stats& a_right )
+                {
+                    return a_left.convoy_score() > a_right.convoy_score();
+                }
+            );
+            return result;
+        }
+
+        void
+        reset()
+        {
+            for( auto &stripe : m_stripes )
+            {
+                stripe.with_lock(
+                    []( stripe_map& a_states )
+                    {
+                        a_states.clear();
+                    }
+                );
+            }
+        }
+
+        void
+        on_release(
+            const lock_event &a_event
+        ) noexcept override
+        {
+            if( a_event.mode != lock_mode::exclusive )
+            {
+                return;
+            }
+
+            const auto cpu = detail::current_cpu();
+
+            try
+            {
+                m_stripes[a_event.wrapper % stripe_count].with_lock(
+                    [&]( stripe_map& a_states )
+                    {
+                        hold_back( a_states[a_event.wrapper], a_event, cpu );
+                    }
+                );
+            }
+            catch( ... )
+            {
+                // Out of memory for a new wrapper: it goes unobserved.
+            }
+        }
+
+        /**
+         * @brief Forgets a destroyed wrapper.
+         */
+        void
+        on_destroy(
+            std::uint32_t                       a_wrapper,
+            [[maybe_unused]] const std::string &a_name
+        ) noexcept override
+        {
+            m_stripes[a_wrapper % stripe_count].with_lock(
+                [a_wrapper]( stripe_map& a_states )
+                {
+                    a_states.erase( a_wrapper );
+                }
+            );
+        }
+
+    private:
+        using stripe_map
+            = std::unordered_map<std::uint32_t, detail::convoy_state>;
+
+        /**
+         * @brief Wrappers are spread over stripes, so the detector does not
+         * serialize unrelated wrappers.
+         */
+        static constexpr std::size_t stripe_count = 64;
+
+        using stripe_array
+            = std::array<zdm::lock_wrapper<stripe_map>, stripe_count>;
+
+        /**
+         * @brief Adds a release to the wrapper's pending ones, in order of
+         * acquisition, and follows the oldest once there are more than
+         * `reorder_window`.
+         */
+        void
+        hold_back(
+            detail::convoy_state &a_state,
+            const lock_event     &a_event,
+            int                   a_cpu
+        ) const
+        {
+            const detail::convoy_release release{ a_event, a_cpu };
+            auto                        &pending = a_state.pending;
+
+            pending.insert(
+                std::ranges::upper_bound(
+                    pending,
+                    release.acquired_ns(),
+                    {},
+                    &detail::convoy_release::acquired_ns
+                ),
+                release
+            );
+
+            if( pending.size() > reorder_window )
+            {
+                record( a_state, pending.front().event, pending.front().cpu );
+                pending.erase( pending.begin() );
+            }
+        }
+
+        /**
+         * @brief The statistics of a wrapper once its pending releases are
+         * followed.
+         */
+        convoy_stats
+        flushed(
+            detail::convoy_state a_state
+        ) const noexcept
+        {
+            for( const auto &release : a_state.pending )
+            {
+                record( a_state, release.event, release.cpu );
+            }
+
+            return a_state.stats;
+        }
+
+        void
+        record(
+            detail::convoy_state &a_state,
+            const lock_event     &a_event,
+            int                   a_cpu
+        ) const noexcept
+        {
+            auto      &stats = a_state.stats;
+            const bool first = stats.acquisitions++ == 0;
+
+            stats.wrapper = a_event.wrapper;
+
+            if( !first && a_event.contended
+                && a_event.thread != a_state.last_thread )
+            {
+                ++stats.contended_handoffs;
+
+                if( a_cpu < 0 || a_cpu != a_state.last_cpu )
+                {
+                    ++stats.migrations;
+                }
+
+                if( ++a_state.chain == m_convoy_length )
+                {
+                    stats.convoy_acquisitions += m_convoy_length;
+                }
+                else if( a_state.chain > m_convoy_length )
+                {
+                    ++stats.convoy_acquisitions;
+                }
+
+                stats.longest_chain
+                    = std::max( stats.longest_chain, a_state.chain );
+            }
+            else
+            {
+                a_state.chain = 0;
+            }
+
+            a_state.last_thread = a_event.thread;
+            a_state.last_cpu    = a_cpu;
+        }
+
+        const std::uint64_t m_convoy_length;
+        std::atomic<bool>   m_started{ false };
+        stripe_array        m_stripes;
+};
+
+} // namespace zdm::instrumentation
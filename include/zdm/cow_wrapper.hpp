@@ -0,0 +1,190 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <source_location>
+#include <utility>
+#include <zdm/lock_wrapper.hpp>
+#include <zdm/shared_lock_wrapper.hpp>
+
+namespace zdm::detail {
+
+template <class T>
+struct cow_state
+{
+        std::shared_ptr<T> value;
+        std::uint64_t      version = 0;
+};
+
+} // namespace zdm::detail
+
+namespace zdm {
+
+/**
+ * @brief A lock wrapper whose contents can be snapshotted in constant time.
+ *
+ * `snapshot` shares the contained object instead of copying it, holding the
+ * lock only to copy a `std::shared_ptr`. The first mutating `with_lock`
+ * after a snapshot was taken copies the object once, so snapshots never see
+ * later changes, even if the snapshot has been dropped by then. Without
+ * snapshots taken since the last copy, mutations work in place.
+ *
+ * Meant for large state that is read as a whole outside the lock, such as
+ * tables written to disk by `zdm::checkpoint`.
+ */
+template <class AContainedType, zdm::concepts::lockable AMutexType>
+class basic_cow_wrapper
+{
+    public:
+        basic_cow_wrapper()
+            : basic_cow_wrapper( AContainedType{} )
+        {
+        }
+
+        explicit basic_cow_wrapper(
+            AContainedType &&a_contained
+        )
+            : m_wrapper( detail::cow_state<AContainedType>{
+                  std::make_shared<AContainedType>(
+                      std::forward<AContainedType>( a_contained )
+                  ),
+                  0,
+              } )
+        {
+        }
+
+        basic_cow_wrapper( const basic_cow_wrapper & )            = delete;
+        basic_cow_wrapper &operator=( const basic_cow_wrapper & ) = delete;
+
+        /**
+         * @copydoc basic_lock_wrapper::with_lock
+         *
+         * Copies the contained object first if a snapshot was taken since
+         * the last copy.
+         */
+        inline auto
+        with_lock(
+            concepts::unary_reference_function<AContainedType> auto
+                                       &&a_function,
+            const std::source_location &a_site
+            = std::source_location::current()
+        ) -> decltype( a_function( std::declval<AContainedType &>() ) )
+        {
+            return m_wrapper.with_lock(
+                [this, &a_function](
+                    detail::cow_state<AContainedType> &a_state
+                ) -> decltype( auto )
+                {
+                    // Snapshots are taken under the lock, so one taken before
+                    // this mutation has set the flag, and none can be taken
+                    // until it ends.
+                    if( m_shared.exchange( false, std::memory_order_relaxed ) )
+                    {
+                        a_state.value = std::make_shared<AContainedType>(
+                            std::as_const( *a_state.value )
+                        );
+                    }
+
+                    ++a_state.version;
+                    return a_function( *a_state.value );
+                },
+                a_site
+            );
+        }
+
+        /**
+         * @copydoc basic_lock_wrapper::with_lock
+         */
+        inline auto
+        with_lock(
+            concepts::unary_const_reference_function<AContainedType> auto
+                                       &&a_function,
+            const std::source_location &a_site
+            = std::source_location::current()
+        ) const
+            -> decltype( a_function( std::declval<const AContainedType &>() ) )
+        {
+            return m_wrapper.with_lock(
+                [&a_function](
+                    const detail::cow_state<AContainedType> &a_state
+                ) -> decltype( auto )
+                {
+                    return a_function( std::as_const( *a_state.value ) );
+                },
+                a_site
+            );
+        }
+
+        /**
+         * @brief The contained object as it is now, unaffected by later
+         * changes.
+         */
+        std::shared_ptr<const AContainedType>
+        snapshot() const
+        {
+            return m_wrapper.with_lock(
+                [this]( const detail::cow_state<AContainedType>& a_state )
+                {
+                    // Atomic, as snapshots may be taken under a shared lock.
+                    m_shared.store( true, std::memory_order_relaxed );
+                    return std::shared_ptr<const AContainedType>(
+                        a_state.value
+                    );
+                }
+            );
+        }
+
+        /**
+         * @brief The number of mutating `with_lock` calls so far, to skip
+         * checkpoints of unchanged state.
+         */
+        std::uint64_t
+        version() const
+        {
+            return m_wrapper.with_lock(
+                []( const detail::cow_state<AContainedType>& a_state )
+                {
+                    return a_state.version;
+                }
+            );
+        }
+
+    private:
+        basic_lock_wrapper<detail::cow_state<AContainedType>, AMutexType>
+            m_wrapper;
+        /** @brief Whether a snapshot was taken since the last copy. */
+        mutable std::atomic<bool> m_shared{ false };
+};
+
+template <class T>
+using cow_wrapper = basic_cow_wrapper<T, std::mutex>;
+
+template <class T>
+using shared_cow_wrapper = basic_cow_wrapper<T, std::shared_mutex>;
+
+} // namespace zdm
@@ -0,0 +1,407 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <concepts>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <source_location>
+#include <type_traits>
+#include <utility>
+#include <zdm/detail/lock_wrapper_concepts.hpp>
+#include <zdm/detail/lock_wrapper_mutex_traits.hpp>
+#include <zdm/detail/locked_range.hpp>
+
+/**
+ * @brief Define `ZDM_LOCK_WRAPPER_USDT` to place USDT probes in `with_lock`.
+ *
+ * The probes are `zdm_lock_wrapper:wait_begin`, `zdm_lock_wrapper:acquired`
+ * and `zdm_lock_wrapper:released`. Each takes the address of the mutex and
+ * the lock mode, 0 for exclusive and 1 for shared. A probe is a single nop
+ * until a tracer such as bpftrace or perf attaches to it. Without the macro
+ * the probes are not compiled in at all.
+ */
+#if defined( ZDM_LOCK_WRAPPER_USDT )
+#if !__has_include( <sys/sdt.h> )
+#error "ZDM_LOCK_WRAPPER_USDT requires <sys/sdt.h> (systemtap-sdt-dev)"
+#endif
+#include <sys/sdt.h>
+#define ZDM_LOCK_WRAPPER_PROBE( a_name, a_mutex, a_mode ) \
+    DTRACE_PROBE2( zdm_lock_wrapper, a_name, a_mutex, a_mode )
+#else
+#define ZDM_LOCK_WRAPPER_PROBE( a_name, a_mutex, a_mode )
+#endif
+
+namespace zdm::detail {
+
+/**
+ * @brief Whether `ALock` can be constructed with `std::try_to_lock` and
+ * reports whether it acquired the mutex.
+ */
+template <class ALock, class AMutex>
+concept try_lock_constructible
+    = std::constructible_from<ALock, AMutex &, std::try_to_lock_t>
+   && requires( const ALock &a_lock ) {
+          { a_lock.owns_lock() } -> std::convertible_to<bool>;
+      };
+
+/**
+ * @brief The lock used by `try_with_lock`: `ALock` when it supports
+ * `std::try_to_lock`, otherwise an exclusive `std::unique_lock`.
+ */
+template <class ALock, class AMutex>
+using try_lock_t = std::conditional_t<
+    try_lock_constructible<ALock, AMutex>,
+    ALock,
+    std::unique_lock<AMutex>>;
+
+/**
+ * @brief The result of `try_with_lock`: `bool` for functions returning
+ * `void`, otherwise an optional holding the function's result. A returned
+ * reference is copied, under the lock.
+ */
+template <class AResult>
+using try_with_lock_result_t = std::conditional_t<
+    std::is_void_v<AResult>,
+    bool,
+    std::optional<std::remove_cvref_t<AResult>>>;
+
+/**
+ * @brief Fires the USDT probes around a `with_lock` call. Declared before
+ * the lock, so `released` fires once the lock is gone.
+ */
+class lock_probe_scope
+{
+    public:
+        lock_probe_scope(
+            [[maybe_unused]] const void *a_mutex,
+            [[maybe_unused]] int         a_mode
+        ) noexcept
+#if defined( ZDM_LOCK_WRAPPER_USDT )
+            : m_mutex( a_mutex )
+            , m_mode( a_mode )
+#endif
+        {
+            ZDM_LOCK_WRAPPER_PROBE( wait_begin, a_mutex, a_mode );
+        }
+
+        lock_probe_scope( const lock_probe_scope & ) = delete;
+
+        lock_probe_scope &
+        operator=( const lock_probe_scope & ) = delete;
+
+        ~lock_probe_scope()
+        {
+            ZDM_LOCK_WRAPPER_PROBE( released, m_mutex, m_mode );
+        }
+
+        void
+        acquired() const noexcept
+        {
+            ZDM_LOCK_WRAPPER_PROBE( acquired, m_mutex, m_mode );
+        }
+
+#if defined( ZDM_LOCK_WRAPPER_USDT )
+    private:
+        const void *m_mutex;
+        int         m_mode;
+#endif
+};
+
+/**
+ * @brief Passes the site of a `with_lock` call to mutexes that track it,
+ * such as `zdm::instrumented_mutex`.
+ */
+template <class AMutex>
+inline void
+note_acquisition_site(
+    AMutex                                      &a_mutex,
+    [[maybe_unused]] const std::source_location &a_site
+) noexcept
+{
+    if constexpr( requires { a_mutex.set_acquisition_site( a_site ); } )
+    {
+        a_mutex.set_acquisition_site( a_site );
+    }
+}
+
+} // namespace zdm::detail
+
+namespace zdm {
+
+template <class AContainedType, zdm::concepts::lockable AMutexType>
+class basic_lock_wrapper
+{
+    public:
+        basic_lock_wrapper() = default;
+
+        explicit basic_lock_wrapper(
+            AContainedType &&a_contained
+        )
+            : m_contained( std::forward<AContainedType>( a_contained ) )
+        {
+        }
+
+        AContainedType &
+        operator*() noexcept
+        {
+            return m_contained;
+        }
+
+        const AContainedType &
+        operator*() const noexcept
+        {
+            return m_contained;
+        }
+
+        AContainedType *
+        operator->() noexcept
+        {
+            return &m_contained;
+        }
+
+        const AContainedType *
+        operator->() const noexcept
+        {
+            return &m_contained;
+        }
+
+        /**
+         * @brief The wrapper's mutex.
+         *
+         * Meant for mutex adapters that expose state of their own, such as
+         * `zdm::versioned_mutex`. Locking it directly bypasses `with_lock`.
+         */
+        typename mutex_traits<AMutexType>::mutex_type &
+        mutex() const noexcept
+        {
+            return m_mutex;
+        }
+
+        /**
+         * @brief Executes a function with a lock on the contained object.
+         *
+         * @tparam AFunction Any callable that takes a reference to the
+         * contained object.
+         * @param a_function A callable that takes a reference to the contained
+         * object.
+         * @param a_site Where the lock is requested, for instrumented
+         * mutexes.
+         * @return The result of the function.
+         */
+        inline auto
+        with_lock(
+            concepts::unary_reference_function<AContainedType> auto
+                                       &&a_function,
+            const std::source_location &a_site
+            = std::source_location::current()
+        ) -> decltype( a_function( std::declval<AContainedType &>() ) )
+        {
+            detail::lock_probe_scope probe( &m_mutex, 0 );
+            detail::note_acquisition_site( m_mutex, a_site );
+            typename mutex_traits<AMutexType>::unique_lock lock( m_mutex );
+            probe.acquired();
+
+            if constexpr( std::is_void_v<decltype( a_function( m_contained )
+                          )> )
+            {
+                a_function( m_contained );
+                return;
+            }
+            else
+            {
+                return a_function( m_contained );
+            }
+        }
+
+        /**
+         * @brief Executes a function with a lock on the contained object.
+         *
+         * @tparam AFunction Any callable that takes a const reference to the
+         * contained object.
+         * @param a_function A callable that takes a const reference to the
+         * contained object.
+         * @param a_site Where the lock is requested, for instrumented
+         * mutexes.
+         * @return The result of the function.
+         */
+        inline auto
+        with_lock(
+            concepts::unary_const_reference_function<AContainedType> auto
+                                       &&a_function,
+            const std::source_location &a_site
+            = std::source_location::current()
+        ) const
+            -> decltype( a_function( std::declval<const AContainedType &>() ) )
+        {
+            detail::lock_probe_scope probe( &m_mutex, 1 );
+            detail::note_acquisition_site( m_mutex, a_site );
+            typename mutex_traits<AMutexType>::shared_lock lock( m_mutex );
+            probe.acquired();
+
+            if constexpr( std::is_void_v<decltype( a_function( m_contained )
+                          )> )
+            {
+                a_function( m_contained );
+                return;
+            }
+            else
+            {
+                return a_function( m_contained );
+            }
+        }
+
+        /**
+         * @brief Executes a function with a lock on the contained object if
+         * the lock can be acquired without blocking.
+         *
+         * @tparam AFunction Any callable that takes a reference to the
+         * contained object.
+         * @param a_function A callable that takes a reference to the contained
+         * object.
+         * @param a_site Where the lock is requested, for instrumented
+         * mutexes.
+         * @return `true` or the result of the function if the lock was
+         * acquired, otherwise `false` or an empty optional.
+         */
+        inline auto
+        try_with_lock(
+            concepts::unary_reference_function<AContainedType> auto
+                                       &&a_function,
+            const std::source_location &a_site
+            = std::source_location::current()
+        )
+            -> detail::try_with_lock_result_t<
+                decltype( a_function( std::declval<AContainedType &>() ) )>
+        {
+            using mutex_type = typename mutex_traits<AMutexType>::mutex_type;
+
+            detail::note_acquisition_site( m_mutex, a_site );
+            detail::try_lock_t<
+                typename mutex_traits<AMutexType>::unique_lock,
+                mutex_type>
+                lock( m_mutex, std::try_to_lock );
+
+            if( !lock.owns_lock() )
+            {
+                return {};
+            }
+
+            if constexpr( std::is_void_v<decltype( a_function( m_contained )
+                          )> )
+            {
+                a_function( m_contained );
+                return true;
+            }
+            else
+            {
+                return a_function( m_contained );
+            }
+        }
+
+        /**
+         * @brief Executes a function with a lock on the contained object if
+         * the lock can be acquired without blocking.
+         *
+         * @tparam AFunction Any callable that takes a const reference to the
+         * contained object.
+         * @param a_function A callable that takes a const reference to the
+         * contained object.
+         * @param a_site Where the lock is requested, for instrumented
+         * mutexes.
+         * @return `true` or the result of the function if the lock was
+         * acquired, otherwise `false` or an empty optional.
+         */
+        inline auto
+        try_with_lock(
+            concepts::unary_const_reference_function<AContainedType> auto
+                                       &&a_function,
+            const std::source_location &a_site
+            = std::source_location::current()
+        ) const
+            -> detail::try_with_lock_result_t<
+                decltype( a_function( std::declval<const AContainedType &>() )
+                )>
+        {
+            using mutex_type = typename mutex_traits<AMutexType>::mutex_type;
+
+            detail::note_acquisition_site( m_mutex, a_site );
+            detail::try_lock_t<
+                typename mutex_traits<AMutexType>::shared_lock,
+                mutex_type>
+                lock( m_mutex, std::try_to_lock );
+
+            if( !lock.owns_lock() )
+            {
+                return {};
+            }
+
+            if constexpr( std::is_void_v<decltype( a_function( m_contained )
+                          )> )
+            {
+                a_function( m_contained );
+                return true;
+            }
+            else
+            {
+                return a_function( m_contained );
+            }
+        }
+
+        /**
+         * @brief A range over the contained container that holds the lock
+         * until it is destroyed, shared when the mutex supports it.
+         *
+         * Use it to iterate the container, or build `std::views` pipelines
+         * over it, without copying it out of a const `with_lock`. Do not lock
+         * the wrapper again while the range is alive.
+         *
+         * @param a_site Where the lock is requested, for instrumented
+         * mutexes.
+         */
+        auto
+        locked_view(
+            const std::source_location &a_site
+            = std::source_location::current()
+        ) const
+            requires requires( const AContainedType &a_contained ) {
+                std::ranges::begin( a_contained );
+                std::ranges::end( a_contained );
+            }
+        {
+            using lock_type = detail::range_lock_t<AMutexType>;
+
+            detail::note_acquisition_site( m_mutex, a_site );
+            return zdm::locked_range<AContainedType, lock_type>(
+                m_contained,
+                lock_type( m_mutex )
+            );
+        }
+
+    private:
+        mutable typename mutex_traits<AMutexType>::mutex_type m_mutex;
+        AContainedType                                        m_contained;
+};
+
+} // namespace zdm
@@ -0,0 +1,67 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+
+#if defined( __linux__ )
+#include <sched.h>
+#include <sys/sysinfo.h>
+#endif
+
+namespace zdm::detail {
+
+/**
+ * @brief The CPU the calling thread runs on, or -1 when unknown.
+ *
+ * Since glibc 2.35, `sched_getcpu` reads the CPU id from the thread's rseq
+ * area instead of making a system call.
+ */
+inline int
+current_cpu() noexcept
+{
+#if defined( __linux__ )
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+/**
+ * @brief The number of CPUs configured on the system, including offline
+ * ones, so that every id returned by `current_cpu` is below it.
+ */
+inline std::size_t
+cpu_count() noexcept
+{
+#if defined( __linux__ )
+    const auto configured = get_nprocs_conf();
+#else
+    const auto configured = std::thread::hardware_concurrency();
+#endif
+    return std::max<std::size_t>( static_cast<std::size_t>( configured ), 1 );
+}
+
+} // namespace zdm::detail
@@ -0,0 +1,146 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <concepts>
+#include <tuple>
+#include <type_traits>
+
+namespace zdm::detail {
+
+template <typename F>
+struct function_traits;
+
+template <typename R, typename... Args>
+struct function_traits<R ( & )( Args... )>
+{
+        using return_type = R;
+        using arg_types   = std::tuple<Args...>;
+};
+
+template <typename R, typename... Args>
+struct function_traits<R ( * )( Args... )>
+{
+        using return_type = R;
+        using arg_types   = std::tuple<Args...>;
+};
+
+template <typename R, typename... Args>
+struct function_traits<R( Args... )>
+{
+        using return_type = R;
+        using arg_types   = std::tuple<Args...>;
+};
+
+template <typename R, typename Class, typename... Args>
+struct function_traits<R ( Class::* )( Args... ) const>
+{
+        using return_type = R;
+        using arg_types   = std::tuple<Args...>;
+};
+
+/**
+ * @brief The parameter type of a callable with a single parameter, used by
+ * the `unary_*_function` concepts. Unlike `function_traits` it does not
+ * build a `std::tuple`, which keeps the concept checks cheap to compile.
+ * Has no `type` for other callables.
+ */
+template <class AFunction>
+struct unary_argument
+{
+};
+
+template <class AResult, class AArgument>
+struct unary_argument<AResult( AArgument )>
+{
+        using type = AArgument;
+};
+
+template <class AResult, class AArgument>
+struct unary_argument<AResult ( * )( AArgument )>
+{
+        using type = AArgument;
+};
+
+template <class AResult, class AClass, class AArgument>
+struct unary_argument<AResult ( AClass::* )( AArgument ) const>
+{
+        using type = AArgument;
+};
+
+template <class AFunction>
+struct unary_argument_of : unary_argument<AFunction>
+{
+};
+
+template <class AFunction>
+    requires requires { &AFunction::operator(); }
+struct unary_argument_of<AFunction>
+    : unary_argument<decltype( &AFunction::operator() )>
+{
+};
+
+template <class AFunction>
+using unary_argument_t =
+    typename unary_argument_of<std::remove_cvref_t<AFunction>>::type;
+
+} // namespace zdm::detail
+
+namespace zdm::concepts {
+
+/**
+ * @brief Concept for a lockable type such as a mutex.
+ */
+template <class ALockable>
+concept lockable = requires( ALockable &a_lockable ) {
+    { a_lockable.lock() } -> std::same_as<void>;
+    { a_lockable.unlock() } -> std::same_as<void>;
+};
+
+/**
+ * @brief Concept for a lockable type that can also be locked shared, such as
+ * `std::shared_mutex`.
+ */
+template <class ALockable>
+concept shared_lockable
+    = lockable<ALockable> && requires( ALockable &a_lockable ) {
+          { a_lockable.lock_shared() } -> std::same_as<void>;
+          { a_lockable.unlock_shared() } -> std::same_as<void>;
+      };
+
+/**
+ * @brief Concept for a callable taking exactly a `T &`, such as
+ * `void( int & )` or `[]( int &a_value ) {}`.
+ */
+template <class AFunction, class T>
+concept unary_reference_function
+    = std::same_as<zdm::detail::unary_argument_t<AFunction>, T &>;
+
+/**
+ * @brief Concept for a callable taking exactly a `const T &`.
+ */
+template <class AFunction, class T>
+concept unary_const_reference_function
+    = std::same_as<zdm::detail::unary_argument_t<AFunction>, const T &>;
+
+} // namespace zdm::concepts
@@ -0,0 +1,64 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <mutex>
+#include <zdm/detail/lock_wrapper_concepts.hpp>
+
+namespace zdm {
+
+/**
+ * @brief Traits for mutex types.
+ *
+ * This is used for `zdm::lock_wrapper`. If you wish to use a custom mutex
+ * type, then specialize this template and define the following aliases:
+ * - `mutex_type`: The type of mutex to use, such as `std::mutex`.
+ * - `unique_lock`: The type of unique lock to use, such as
+ * `std::scoped_lock<mutex_type>` or `std::unique_lock<mutex_type>`.
+ * - `shared_lock`: The type of shared lock to use, such as
+ * `std::scoped_lock<mutex_type>` or `std::shared_lock<mutex_type>`.
+ *
+ * `unique_lock` and `shared_lock` are used for the `with_lock` function.
+ * `with_lock` has overloads for reference and const reference functions,
+ *  so use the appropriate lock type for your use case.
+ */
+template <zdm::concepts::lockable ALockable>
+struct mutex_traits;
+
+template <>
+struct mutex_traits<std::mutex>
+{
+        using mutex_type  = std::mutex;
+        using unique_lock = std::scoped_lock<mutex_type>;
+        using shared_lock = std::scoped_lock<mutex_type>;
+};
+
+template <>
+struct mutex_traits<std::recursive_mutex>
+{
+        using mutex_type  = std::recursive_mutex;
+        using unique_lock = std::scoped_lock<mutex_type>;
+        using shared_lock = std::scoped_lock<mutex_type>;
+};
+
+} // namespace zdm
@@ -0,0 +1,102 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <concepts>
+#include <iterator>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <zdm/detail/lock_wrapper_mutex_traits.hpp>
+
+namespace zdm::detail {
+
+/**
+ * @brief The lock held by a `zdm::locked_range`: the mutex's shared lock
+ * when it can be moved, otherwise an exclusive `std::unique_lock`.
+ */
+template <class AMutex>
+using range_lock_t = std::conditional_t<
+    std::movable<typename mutex_traits<AMutex>::shared_lock>,
+    typename mutex_traits<AMutex>::shared_lock,
+    std::unique_lock<typename mutex_traits<AMutex>::mutex_type>>;
+
+} // namespace zdm::detail
+
+namespace zdm {
+
+/**
+ * @brief A range over a wrapped container that holds the wrapper's lock
+ * until it is destroyed, returned by `basic_lock_wrapper::locked_view`.
+ *
+ * It iterates the container in place, so `std::views` pipelines can be built
+ * over it without copying the container out. A pipeline built from a
+ * temporary `locked_range` owns it, and holds the lock as long as it lives.
+ */
+template <class AContainedType, class ALock>
+class locked_range
+{
+    public:
+        locked_range(
+            const AContainedType &a_contained,
+            ALock               &&a_lock
+        ) noexcept
+            : m_lock( std::move( a_lock ) )
+            , m_contained( &a_contained )
+        {
+        }
+
+        auto
+        begin() const
+        {
+            return std::ranges::begin( *m_contained );
+        }
+
+        auto
+        end() const
+        {
+            return std::ranges::end( *m_contained );
+        }
+
+        auto
+        size() const
+            requires requires( const AContainedType &a_contained ) {
+                std::ranges::size( a_contained );
+            }
+        {
+            return std::ranges::size( *m_contained );
+        }
+
+        bool
+        empty() const
+        {
+            return std::ranges::begin( *m_contained )
+                == std::ranges::end( *m_contained );
+        }
+
+    private:
+        ALock                 m_lock;
+        const AContainedType *m_contained;
+};
+
+} // namespace zdm
@@ -0,0 +1,97 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace zdm::detail {
+
+/**
+ * @brief Numbers the temporary files of `replace_file`, so concurrent writes
+ * of one path within the process never share one.
+ */
+inline std::atomic<std::uint64_t> replace_file_counter{ 0 };
+
+/**
+ * @brief Writes a file through `a_write` into a temporary file next to
+ * `a_path`, then renames it over `a_path`, so readers never see a partial
+ * file.
+ *
+ * The temporary file is removed if writing it fails or `a_write` throws. Its
+ * data is not synced to disk before the rename, so after a system crash
+ * `a_path` may hold an empty or partial file.
+ *
+ * @param a_write Called with the `std::ofstream` to write.
+ * @return `false` if the file could not be written or renamed.
+ */
+template <class AWrite>
+bool
+replace_file(
+    const std::filesystem::path &a_path,
+    std::ios::openmode           a_mode,
+    AWrite                     &&a_write
+)
+{
+    auto temporary = a_path;
+    temporary += ".tmp" + std::to_string( replace_file_counter.fetch_add( 1 ) );
+
+    std::error_code error;
+
+    try
+    {
+        std::ofstream stream( temporary, a_mode | std::ios::trunc );
+        std::forward<AWrite>( a_write )( stream );
+
+        if( !stream.flush() )
+        {
+            stream.close();
+            std::filesystem::remove( temporary, error );
+            return false;
+        }
+    }
+    catch( ... )
+    {
+        std::filesystem::remove( temporary, error );
+        throw;
+    }
+
+    std::filesystem::rename( temporary, a_path, error );
+
+    if( error )
+    {
+        std::error_code ignored;
+        std::filesystem::remove( temporary, ignored );
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace zdm::detail
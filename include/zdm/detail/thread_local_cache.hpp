@@ -0,0 +1,163 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace zdm::detail {
+
+/**
+ * @brief The generations of every live `zdm::detail::thread_local_cache`.
+ */
+struct thread_local_cache_generations
+{
+        std::atomic<std::uint64_t>        next{ 1 };
+        std::atomic<std::uint64_t>        retired{ 0 };
+        std::mutex                        mutex;
+        std::unordered_set<std::uint64_t> live;
+
+        static thread_local_cache_generations &
+        instance()
+        {
+            static thread_local_cache_generations s_generations;
+            return s_generations;
+        }
+};
+
+/**
+ * @brief Hands every thread a `T` of its own, created by its owner on the
+ * thread's first lookup.
+ *
+ * Each cache gets a process unique generation, and threads keep a map from
+ * generation to their `T` for every cache of that type they used, so threads
+ * using several owners at once do not create a new `T` on every switch. The
+ * last lookup is remembered, which keeps the common single owner case to one
+ * comparison. Destroying a cache retires its generation, and threads drop the
+ * entries of retired generations on their next miss.
+ *
+ * The `T`s are owned by the owner of the cache, which must keep them alive
+ * for as long as the cache.
+ */
+template <class T>
+class thread_local_cache
+{
+    public:
+        thread_local_cache()
+        {
+            auto &generations = thread_local_cache_generations::instance();
+            m_generation      = generations.next.fetch_add( 1 );
+
+            std::scoped_lock lock( generations.mutex );
+            generations.live.insert( m_generation );
+        }
+
+        thread_local_cache( const thread_local_cache & ) = delete;
+        thread_local_cache &
+        operator=( const thread_local_cache & ) = delete;
+
+        ~thread_local_cache()
+        {
+            auto &generations = thread_local_cache_generations::instance();
+
+            {
+                std::scoped_lock lock( generations.mutex );
+                generations.live.erase( m_generation );
+            }
+
+            generations.retired.fetch_add( 1 );
+        }
+
+        /**
+         * @brief The calling thread's `T`, created with `a_make` on its first
+         * lookup. `a_make` returns a `T *` that stays valid for as long as the
+         * cache, and may throw, in which case the next lookup calls it again.
+         */
+        template <class AMake>
+        T &
+        local(
+            AMake &&a_make
+        )
+        {
+            thread_local entries t_entries;
+
+            if( t_entries.generation != m_generation )
+            {
+                prune( t_entries );
+
+                auto &local = t_entries.locals[m_generation];
+
+                if( local == nullptr )
+                {
+                    local = std::forward<AMake>( a_make )();
+                }
+
+                t_entries.generation = m_generation;
+                t_entries.last       = local;
+            }
+
+            return *t_entries.last;
+        }
+
+    private:
+        struct entries
+        {
+                std::uint64_t                          generation = 0;
+                T                                     *last       = nullptr;
+                std::uint64_t                          retired    = 0;
+                std::unordered_map<std::uint64_t, T *> locals;
+        };
+
+        static void
+        prune(
+            entries &a_entries
+        )
+        {
+            auto      &generations = thread_local_cache_generations::instance();
+            const auto retired     = generations.retired.load();
+
+            if( retired == a_entries.retired )
+            {
+                return;
+            }
+
+            std::scoped_lock lock( generations.mutex );
+
+            std::erase_if(
+                a_entries.locals,
+                [&generations]( const auto& a_entry )
+                {
+                    return !generations.live.contains( a_entry.first );
+                }
+            );
+            a_entries.retired = retired;
+        }
+
+        std::uint64_t m_generation = 0;
+};
+
+} // namespace zdm::detail
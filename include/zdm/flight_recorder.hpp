@@ -0,0 +1,474 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <zdm/lock_event.hpp>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#include <csignal>
+#include <signal.h>
+#include <unistd.h>
+#define ZDM_FLIGHT_RECORDER_POSIX 1
+#endif
+
+/**
+ * @brief The number of events each thread keeps. Must be a power of two.
+ */
+#ifndef ZDM_FLIGHT_RECORDER_CAPACITY
+#define ZDM_FLIGHT_RECORDER_CAPACITY 4096
+#endif
+
+namespace zdm::instrumentation {
+
+enum class flight_event_kind : std::uint8_t
+{
+    /** @brief The lock was busy and the thread starts waiting. */
+    contended,
+    acquire,
+    release
+};
+
+struct flight_event
+{
+        std::uint64_t     time_ns = 0;
+        std::uint32_t     thread  = 0;
+        std::uint32_t     wrapper = 0;
+        flight_event_kind kind    = flight_event_kind::acquire;
+        lock_mode         mode    = lock_mode::exclusive;
+};
+
+} // namespace zdm::instrumentation
+
+namespace zdm::detail {
+
+/**
+ * @brief The ring buffer of one thread.
+ *
+ * Only the owning thread writes. Every slot carries a sequence number that
+ * is published after its payload, so readers on other threads, or in a
+ * signal handler, can tell whether a slot was overwritten while they copied
+ * it. Rings are never freed. A ring is released when its thread exits and is
+ * then reused by a later thread.
+ */
+struct flight_ring
+{
+        static constexpr std::size_t capacity = ZDM_FLIGHT_RECORDER_CAPACITY;
+
+        static_assert(
+            capacity != 0 && ( capacity & ( capacity - 1 ) ) == 0,
+            "ZDM_FLIGHT_RECORDER_CAPACITY must be a power of two"
+        );
+
+        struct slot
+        {
+                std::atomic<std::uint64_t> sequence{ 0 };
+                std::atomic<std::uint64_t> time_ns{ 0 };
+                std::atomic<std::uint64_t> wrapper_and_thread{ 0 };
+                std::atomic<std::uint64_t> kind_and_mode{ 0 };
+        };
+
+        std::array<slot, capacity> slots;
+        std::atomic<std::uint64_t> head{ 0 };
+        std::atomic<bool>          in_use{ true };
+        flight_ring               *next = nullptr;
+
+        void
+        push(
+            const instrumentation::flight_event &a_event
+        ) noexcept
+        {
+            const auto index = head.load( std::memory_order_relaxed );
+            auto      &entry = slots[index & ( capacity - 1 )];
+
+            entry.sequence.store( 0, std::memory_order_relaxed );
+            std::atomic_thread_fence( std::memory_order_release );
+            entry.time_ns.store( a_event.time_ns, std::memory_order_relaxed );
+            entry.wrapper_and_thread.store(
+                std::uint64_t{ a_event.wrapper } << 32 | a_event.thread,
+                std::memory_order_relaxed
+            );
+            entry.kind_and_mode.store(
+                static_cast<std::uint64_t>( a_event.kind ) << 8
+                    | static_cast<std::uint64_t>( a_event.mode ),
+                std::memory_order_relaxed
+            );
+            entry.sequence.store( index + 1, std::memory_order_release );
+            head.store( index + 1, std::memory_order_release );
+        }
+
+        /**
+         * @brief Copies the event at `a_index` if it was not overwritten
+         * meanwhile. Async signal safe.
+         */
+        bool
+        read(
+            std::uint64_t                  a_index,
+            instrumentation::flight_event &a_event
+        ) const noexcept
+        {
+            const auto &entry    = slots[a_index & ( capacity - 1 )];
+            const auto  sequence = a_index + 1;
+
+            if( entry.sequence.load( std::memory_order_acquire ) != sequence )
+            {
+                return false;
+            }
+
+            const auto time = entry.time_ns.load( std::memory_order_relaxed );
+            const auto identity
+                = entry.wrapper_and_thread.load( std::memory_order_relaxed );
+            const auto kind_and_mode
+                = entry.kind_and_mode.load( std::memory_order_relaxed );
+
+            std::atomic_thread_fence( std::memory_order_acquire );
+
+            if( entry.sequence.load( std::memory_order_relaxed ) != sequence )
+            {
+                return false;
+            }
+
+            a_event.time_ns = time;
+            a_event.wrapper = static_cast<std::uint32_t>( identity >> 32 );
+            a_event.thread  = static_cast<std::uint32_t>( identity );
+            a_event.kind    = static_cast<instrumentation::flight_event_kind>(
+                kind_and_mode >> 8
+            );
+            a_event.mode = static_cast<instrumentation::lock_mode>(
+                kind_and_mode & 0xFF
+            );
+            return true;
+        }
+};
+
+inline std::atomic<flight_ring *> flight_rings{ nullptr };
+inline std::atomic<bool>          flight_recorder_enabled{ true };
+
+inline flight_ring *
+claim_flight_ring()
+{
+    for( auto *ring = flight_rings.load( std::memory_order_acquire ); ring;
+         ring       = ring->next )
+    {
+        bool expected = false;
+
+        if( ring->in_use.compare_exchange_strong( expected, true ) )
+        {
+            return ring;
+        }
+    }
+
+    auto *ring = new flight_ring;
+    ring->next = flight_rings.load( std::memory_order_relaxed );
+
+    while( !flight_rings.compare_exchange_weak(
+        ring->next,
+        ring,
+        std::memory_order_release,
+        std::memory_order_relaxed
+    ) )
+    {
+    }
+
+    return ring;
+}
+
+/**
+ * @brief The calling thread's ring, claimed on first use and released when
+ * the thread exits.
+ */
+inline flight_ring &
+local_flight_ring()
+{
+    struct handle
+    {
+            flight_ring *ring = claim_flight_ring();
+
+            ~handle()
+            {
+                ring->in_use.store( false, std::memory_order_release );
+            }
+    };
+
+    thread_local handle t_handle;
+    return *t_handle.ring;
+}
+
+/**
+ * @brief Formats an unsigned integer without allocating. Async signal safe.
+ */
+inline char *
+format_unsigned(
+    char         *a_out,
+    std::uint64_t a_value
+) noexcept
+{
+    char  digits[20];
+    char *end = digits;
+
+    do
+    {
+        *end++ = static_cast<char>( '0' + a_value % 10 );
+        a_value /= 10;
+    } while( a_value != 0 );
+
+    while( end != digits )
+    {
+        *a_out++ = *--end;
+    }
+
+    return a_out;
+}
+
+inline const char *
+flight_event_kind_name(
+    instrumentation::flight_event_kind a_kind
+) noexcept
+{
+    switch( a_kind )
+    {
+    case instrumentation::flight_event_kind::contended:
+        return "contended";
+    case instrumentation::flight_event_kind::acquire:
+        return "acquire";
+    case instrumentation::flight_event_kind::release:
+        return "release";
+    }
+
+    return "unknown";
+}
+
+} // namespace zdm::detail
+
+namespace zdm::instrumentation {
+
+/**
+ * @brief An always-on record of the most recent lock events of every thread.
+ *
+ * Instrumented wrappers write their contended, acquire and release events to
+ * a lock-free ring buffer of the current thread, which keeps the last
+ * `ZDM_FLIGHT_RECORDER_CAPACITY` events. Writing is a handful of relaxed
+ * stores, so the recorder can stay enabled in production and be read when an
+ * incident happens, from any thread or from a signal handler.
+ */
+class flight_recorder
+{
+    public:
+        static bool
+        enabled() noexcept
+        {
+            return detail::flight_recorder_enabled.load(
+                std::memory_order_relaxed
+            );
+        }
+
+        static void
+        set_enabled(
+            bool a_enabled
+        ) noexcept
+        {
+            detail::flight_recorder_enabled.store(
+                a_enabled,
+                std::memory_order_relaxed
+            );
+        }
+
+        static void
+        record(
+            const flight_event &a_event
+        ) noexcept
+        {
+            if( enabled() )
+            {
+                detail::local_flight_ring().push( a_event );
+            }
+        }
+
+        /**
+         * @brief The recorded events of all threads no older than
+         * `a_since_ns`, ordered by time.
+         */
+        static std::vector<flight_event>
+        snapshot(
+            std::uint64_t a_since_ns = 0
+        )
+        {
+            std::vector<flight_event> events;
+
+            for_each_event(
+                [&]( const flight_event &a_event )
+                {
+                    if( a_event.time_ns >= a_since_ns )
+                    {
+                        events.push_back( a_event );
+                    }
+                }
+            );
+
+            std::ranges::stable_sort( events, {}, &flight_event::time_ns );
+            return events;
+        }
+
+        /**
+         * @brief Writes the events of the last `a_window_ns` nanoseconds as
+         * text, one event per line, including wrapper names.
+         */
+        static void
+        dump(
+            std::ostream &a_stream,
+            std::uint64_t a_window_ns = 5'000'000'000
+        )
+        {
+            const auto now = now_ns();
+
+            for( const auto &event :
+                 snapshot( now > a_window_ns ? now - a_window_ns : 0 ) )
+            {
+                auto name = wrapper_name( event.wrapper );
+
+                if( name.empty() )
+                {
+                    name = std::to_string( event.wrapper );
+                }
+
+                a_stream << event.time_ns << ' ' << event.thread << ' ' << name
+                         << ' ' << detail::flight_event_kind_name( event.kind )
+                         << ' '
+                         << ( event.mode == lock_mode::shared ? 's' : 'x' )
+                         << '\n';
+            }
+        }
+
+        /**
+         * @brief Writes all recorded events as text to a file descriptor,
+         * thread by thread. Async signal safe.
+         */
+        static void
+        dump(
+            [[maybe_unused]] int a_fd
+        ) noexcept
+        {
+#if defined( ZDM_FLIGHT_RECORDER_POSIX )
+            for_each_event(
+                [a_fd]( const flight_event &a_event )
+                {
+                    char  line[128];
+                    char *out = line;
+
+                    out    = detail::format_unsigned( out, a_event.time_ns );
+                    *out++ = ' ';
+                    out    = detail::format_unsigned( out, a_event.thread );
+                    *out++ = ' ';
+                    out    = detail::format_unsigned( out, a_event.wrapper );
+                    *out++ = ' ';
+
+                    for( const char *kind
+                         = detail::flight_event_kind_name( a_event.kind );
+                         *kind;
+                         ++kind )
+                    {
+                        *out++ = *kind;
+                    }
+
+                    *out++ = ' ';
+                    *out++ = a_event.mode == lock_mode::shared ? 's' : 'x';
+                    *out++ = '\n';
+
+                    [[maybe_unused]] const auto written = ::write(
+                        a_fd,
+                        line,
+                        static_cast<std::size_t>( out - line )
+                    );
+                }
+            );
+#endif
+        }
+
+        /**
+         * @brief Dumps all recorded events to standard error whenever the
+         * process receives `a_signal`.
+         *
+         * @return `false` where signals are not supported or the handler
+         * could not be installed.
+         */
+        static bool
+        install_signal_handler(
+            [[maybe_unused]] int a_signal
+        ) noexcept
+        {
+#if defined( ZDM_FLIGHT_RECORDER_POSIX )
+            struct sigaction action
+            {
+            };
+
+            action.sa_handler = []( int )
+            {
+                dump( STDERR_FILENO );
+            };
+            action.sa_flags = SA_RESTART;
+            sigemptyset( &action.sa_mask );
+            return ::sigaction( a_signal, &action, nullptr ) == 0;
+#else
+            return false;
+#endif
+        }
+
+    private:
+        template <class AFunction>
+        static void
+        for_each_event(
+            AFunction &&a_function
+        ) noexcept( noexcept( a_function( std::declval<flight_event &>() ) ) )
+        {
+            for( const auto *ring
+                 = detail::flight_rings.load( std::memory_order_acquire );
+                 ring;
+                 ring = ring->next )
+            {
+                const auto head  = ring->head.load( std::memory_order_acquire );
+                const auto first = head > detail::flight_ring::capacity
+                                     ? head - detail::flight_ring::capacity
+                                     : 0;
+
+                for( auto index = first; index < head; ++index )
+                {
+                    flight_event event;
+
+                    if( ring->read( index, event ) )
+                    {
+                        a_function( event );
+                    }
+                }
+            }
+        }
+};
+
+} // namespace zdm::instrumentation
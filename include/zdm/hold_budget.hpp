@@ -0,0 +1,292 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <source_location>
+#include <utility>
+#include <zdm/lock_wrapper.hpp>
+
+#if defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 )
+#if defined( _MSC_VER )
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define ZDM_HOLD_BUDGET_TSC 1
+#endif
+
+namespace zdm {
+
+/**
+ * @brief A critical section that ran longer than its budget.
+ */
+struct hold_budget_overrun
+{
+        std::chrono::nanoseconds budget{ 0 };
+        std::chrono::nanoseconds elapsed{ 0 };
+        /** @brief The `with_lock_budget` call. */
+        std::source_location     site;
+};
+
+/**
+ * @brief Called with every hold budget overrun. Handlers run from a
+ * destructor, possibly while an exception unwinds, so they must not throw.
+ */
+using hold_budget_handler = void ( * )( const hold_budget_overrun & ) noexcept;
+
+} // namespace zdm
+
+namespace zdm::detail {
+
+/**
+ * @brief The clock timing budgeted critical sections: the TSC where
+ * available, otherwise `std::chrono::steady_clock`.
+ */
+struct budget_clock
+{
+        static std::uint64_t
+        now() noexcept
+        {
+#if defined( ZDM_HOLD_BUDGET_TSC )
+            return __rdtsc();
+#else
+            return static_cast<std::uint64_t>(
+                std::chrono::steady_clock::now().time_since_epoch().count()
+            );
+#endif
+        }
+
+        /**
+         * @brief Nanoseconds per tick. The TSC rate is measured against
+         * `std::chrono::steady_clock` for a millisecond on first use.
+         */
+        static double
+        ns_per_tick() noexcept
+        {
+#if defined( ZDM_HOLD_BUDGET_TSC )
+            static const double s_ns_per_tick = []()
+            {
+                using std::chrono::steady_clock;
+
+                const auto start_time  = steady_clock::now();
+                const auto start_ticks = __rdtsc();
+                auto       end_time    = start_time;
+
+                while( end_time - start_time < std::chrono::milliseconds( 1 ) )
+                {
+                    end_time = steady_clock::now();
+                }
+
+                const auto ticks = __rdtsc() - start_ticks;
+                const std::chrono::duration<double, std::nano> elapsed
+                    = end_time - start_time;
+
+                return ticks == 0
+                         ? 1.0
+                         : elapsed.count() / static_cast<double>( ticks );
+            }();
+            return s_ns_per_tick;
+#else
+            const std::chrono::duration<double, std::nano> tick
+                = std::chrono::steady_clock::duration( 1 );
+
+            return tick.count();
+#endif
+        }
+};
+
+inline std::atomic<hold_budget_handler> hold_budget_handler_slot{ nullptr };
+inline std::atomic<std::uint64_t>       hold_budget_overrun_count{ 0 };
+
+/**
+ * @brief Times one budgeted critical section and reports an overrun when
+ * destroyed, which is after the lock has been released.
+ */
+class hold_budget
+{
+    public:
+        hold_budget(
+            std::chrono::nanoseconds    a_budget,
+            const std::source_location &a_site
+        ) noexcept
+            : m_budget( a_budget )
+            , m_site( a_site )
+        {
+        }
+
+        hold_budget( const hold_budget & )            = delete;
+        hold_budget &operator=( const hold_budget & ) = delete;
+
+        ~hold_budget() noexcept
+        {
+            const auto elapsed = std::chrono::nanoseconds(
+                static_cast<std::chrono::nanoseconds::rep>(
+                    static_cast<double>( m_ticks ) * budget_clock::ns_per_tick()
+                )
+            );
+
+            if( elapsed <= m_budget )
+            {
+                return;
+            }
+
+            hold_budget_overrun_count.fetch_add( 1, std::memory_order_relaxed );
+
+            if( const auto handler = hold_budget_handler_slot.load() )
+            {
+                handler( { m_budget, elapsed, m_site } );
+            }
+        }
+
+        /**
+         * @brief Times the critical section until the returned guard is
+         * destroyed, also when the function throws.
+         */
+        auto
+        time() noexcept
+        {
+            struct guard
+            {
+                    std::uint64_t &ticks;
+                    std::uint64_t  start = budget_clock::now();
+
+                    ~guard()
+                    {
+                        ticks = budget_clock::now() - start;
+                    }
+            };
+
+            return guard{ m_ticks };
+        }
+
+    private:
+        std::chrono::nanoseconds m_budget;
+        std::source_location     m_site;
+        std::uint64_t            m_ticks = 0;
+};
+
+} // namespace zdm::detail
+
+namespace zdm {
+
+/**
+ * @brief Installs the function called with every hold budget overrun.
+ *
+ * The handler runs on the thread that overran the budget, after the lock
+ * was released. It must be thread safe and `noexcept`: it can not fail a
+ * test by throwing, so tests record the overruns it receives and check them
+ * once the `with_lock_budget` call returned.
+ *
+ * @return The previous handler, or null.
+ */
+inline hold_budget_handler
+set_hold_budget_handler(
+    hold_budget_handler a_handler
+) noexcept
+{
+    return detail::hold_budget_handler_slot.exchange( a_handler );
+}
+
+/**
+ * @brief The number of hold budget overruns since the process started.
+ */
+inline std::uint64_t
+hold_budget_overruns() noexcept
+{
+    return detail::hold_budget_overrun_count.load( std::memory_order_relaxed );
+}
+
+/**
+ * @brief Executes a function with a lock on the contained object and
+ * reports an overrun if the function runs longer than `a_budget`.
+ *
+ * Only the function is timed, not the wait for the lock. Overruns are
+ * counted by `zdm::hold_budget_overruns` and passed to the handler installed
+ * with `zdm::set_hold_budget_handler`, along with the call site.
+ *
+ * @param a_wrapper The wrapper to lock.
+ * @param a_budget The longest the function may hold the lock.
+ * @param a_function A callable that takes a reference to the contained
+ * object.
+ * @param a_site The reported call site.
+ * @return The result of the function.
+ */
+template <class AContainedType, class AMutexType>
+inline auto
+with_lock_budget(
+    basic_lock_wrapper<AContainedType, AMutexType>         &a_wrapper,
+    std::chrono::nanoseconds                                a_budget,
+    concepts::unary_reference_function<AContainedType> auto &&a_function,
+    const std::source_location                              &a_site
+    = std::source_location::current()
+) -> decltype( a_function( std::declval<AContainedType &>() ) )
+{
+    detail::hold_budget budget( a_budget, a_site );
+
+    return a_wrapper.with_lock(
+        [&]( AContainedType& a_contained ) -> decltype( auto )
+        {
+            const auto timing = budget.time();
+            return a_function( a_contained );
+        },
+        a_site
+    );
+}
+
+/**
+ * @brief Executes a function with a shared lock on the contained object and
+ * reports an overrun if the function runs longer than `a_budget`.
+ *
+ * @param a_wrapper The wrapper to lock.
+ * @param a_budget The longest the function may hold the lock.
+ * @param a_function A callable that takes a const reference to the contained
+ * object.
+ * @param a_site The reported call site.
+ * @return The result of the function.
+ */
+template <class AContainedType, class AMutexType>
+inline auto
+with_lock_budget(
+    const basic_lock_wrapper<AContainedType, AMutexType>          &a_wrapper,
+    std::chrono::nanoseconds                                       a_budget,
+    concepts::unary_const_reference_function<AContainedType> auto &&a_function,
+    const std::source_location                                     &a_site
+    = std::source_location::current()
+) -> decltype( a_function( std::declval<const AContainedType &>() ) )
+{
+    detail::hold_budget budget( a_budget, a_site );
+
+    return a_wrapper.with_lock(
+        [&]( const AContainedType& a_contained ) -> decltype( auto )
+        {
+            const auto timing = budget.time();
+            return a_function( a_contained );
+        },
+        a_site
+    );
+}
+
+} // namespace zdm
@@ -0,0 +1,835 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <zdm/flight_recorder.hpp>
+#include <zdm/lock_event.hpp>
+#include <zdm/lock_watchdog.hpp>
+#include <zdm/lock_wrapper.hpp>
+
+namespace zdm::instrumentation {
+
+/**
+ * @brief Receives the events of every instrumented wrapper.
+ *
+ * Observers are called outside of the critical section, on the thread that
+ * released the lock, and must be thread safe.
+ */
+class observer
+{
+    public:
+        virtual ~observer() = default;
+
+        virtual void
+        on_release( const lock_event &a_event ) noexcept
+            = 0;
+
+        /**
+         * @brief Called when an instrumented wrapper is destroyed, after its
+         * last event. Its id is not used again, and `a_name` is the name it
+         * had, which `wrapper_name` stops returning once every observer has
+         * been called.
+         */
+        virtual void
+        on_destroy(
+            [[maybe_unused]] std::uint32_t      a_wrapper,
+            [[maybe_unused]] const std::string &a_name
+        ) noexcept
+        {
+        }
+};
+
+} // namespace zdm::instrumentation
+
+namespace zdm::detail {
+
+inline constexpr std::size_t max_instrumentation_observers = 8;
+
+/**
+ * @brief Records the observer section a thread is in, if any.
+ *
+ * A thread enters a section before it releases a lock whose event it will
+ * pass to the observers, and records the value `observer_grace_epoch` had
+ * then. `wait_for_observer_sections` waits for every section entered before
+ * it was called, but not for later ones.
+ */
+struct observer_section_slot
+{
+        std::atomic<std::uint64_t> epoch{ 0 };
+        std::atomic<bool>          in_use{ true };
+        std::atomic<bool>          parked{ false };
+        std::uint32_t              depth = 0;
+        observer_section_slot     *next  = nullptr;
+};
+
+inline std::atomic<observer_section_slot *> observer_section_slots{ nullptr };
+inline std::atomic<std::uint64_t>           observer_grace_epoch{ 1 };
+
+inline observer_section_slot *
+claim_observer_section_slot()
+{
+    for( auto *slot = observer_section_slots.load( std::memory_order_acquire );
+         slot;
+         slot = slot->next )
+    {
+        bool expected = false;
+
+        if( slot->in_use.compare_exchange_strong( expected, true ) )
+        {
+            return slot;
+        }
+    }
+
+    auto *slot = new observer_section_slot;
+    slot->next = observer_section_slots.load( std::memory_order_relaxed );
+
+    while( !observer_section_slots.compare_exchange_weak(
+        slot->next,
+        slot,
+        std::memory_order_release,
+        std::memory_order_relaxed
+    ) )
+    {
+    }
+
+    return slot;
+}
+
+/**
+ * @brief The calling thread's slot, claimed on first use and released when
+ * the thread exits.
+ */
+inline observer_section_slot &
+local_observer_section_slot()
+{
+    struct handle
+    {
+            observer_section_slot *slot = claim_observer_section_slot();
+
+            ~handle()
+            {
+                slot->in_use.store( false, std::memory_order_release );
+            }
+    };
+
+    thread_local handle t_handle;
+    return *t_handle.slot;
+}
+
+/**
+ * @brief Keeps the wrapper of a pending event from being retired until it
+ * goes out of scope. Sections nest.
+ */
+class observer_section
+{
+    public:
+        observer_section()
+            : m_slot( local_observer_section_slot() )
+        {
+            if( m_slot.depth++ == 0 )
+            {
+                m_slot.epoch.store( observer_grace_epoch.load() );
+            }
+        }
+
+        observer_section( const observer_section & )            = delete;
+        observer_section &operator=( const observer_section & ) = delete;
+
+        ~observer_section()
+        {
+            if( --m_slot.depth == 0 )
+            {
+                m_slot.epoch.store( 0 );
+            }
+        }
+
+    private:
+        observer_section_slot &m_slot;
+};
+
+/**
+ * @brief Waits until every observer section that other threads entered
+ * before the call has been left. Sections entered later are not waited for,
+ * so steady lock traffic can not hold it up.
+ *
+ * The calling thread's own section, if it is in one, is skipped. So are the
+ * sections of threads waiting here from inside a section themselves, which
+ * would otherwise wait for each other forever.
+ */
+inline void
+wait_for_observer_sections() noexcept
+{
+    const auto epoch = observer_grace_epoch.fetch_add( 1 ) + 1;
+    auto      &own   = local_observer_section_slot();
+
+    if( own.depth != 0 )
+    {
+        own.parked.store( true );
+    }
+
+    for( auto *slot = observer_section_slots.load( std::memory_order_acquire );
+         slot;
+         slot = slot->next )
+    {
+        if( slot == &own )
+        {
+            continue;
+        }
+
+        for( ;; )
+        {
+            const auto entered = slot->epoch.load();
+
+            if( entered == 0 || entered >= epoch || slot->parked.load() )
+            {
+                break;
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    own.parked.store( false );
+}
+
+/**
+ * @brief A registered observer, with the number of calls into it under way.
+ *
+ * Calls made by threads that are removing the observer themselves, from one
+ * of its callbacks, are counted in `parked` as well, so that removal only
+ * waits for the others.
+ */
+struct observer_slot
+{
+        std::atomic<instrumentation::observer *> observer{ nullptr };
+        std::atomic<std::uint32_t>               calls{ 0 };
+        std::atomic<std::uint32_t>               parked{ 0 };
+        bool                                     removing = false;
+};
+
+struct instrumentation_state
+{
+        std::array<observer_slot, max_instrumentation_observers> observers{};
+
+        std::atomic<std::uint32_t> observer_count{ 0 };
+        std::mutex                 observers_mutex;
+
+        static instrumentation_state &
+        instance()
+        {
+            static instrumentation_state s_state;
+            return s_state;
+        }
+};
+
+/**
+ * @brief The calls the calling thread is making into each observer slot.
+ */
+inline std::array<std::uint32_t, max_instrumentation_observers> &
+local_observer_calls() noexcept
+{
+    thread_local std::array<std::uint32_t, max_instrumentation_observers>
+        t_calls{};
+    return t_calls;
+}
+
+/**
+ * @brief Calls `a_function` with every registered observer, counting the
+ * call in its slot so that `remove_observer` can wait for it.
+ */
+template <class AFunction>
+void
+for_each_observer(
+    AFunction &&a_function
+) noexcept
+{
+    auto &state = instrumentation_state::instance();
+    auto &own   = local_observer_calls();
+
+    for( std::size_t i = 0; i < state.observers.size(); ++i )
+    {
+        auto &slot     = state.observers[i];
+        auto *observer = slot.observer.load();
+
+        if( observer == nullptr )
+        {
+            continue;
+        }
+
+        // Counts the call first, then checks the observer is still there,
+        // so a removal either sees the call or the call sees the removal.
+        slot.calls.fetch_add( 1 );
+
+        if( slot.observer.load() == observer )
+        {
+            ++own[i];
+            a_function( *observer );
+            --own[i];
+        }
+
+        slot.calls.fetch_sub( 1 );
+    }
+}
+
+inline void
+dispatch_release(
+    const instrumentation::lock_event &a_event
+) noexcept
+{
+    auto &state = instrumentation_state::instance();
+
+    if( state.observer_count.load( std::memory_order_relaxed ) == 0 )
+    {
+        return;
+    }
+
+    for_each_observer(
+        [&a_event]( instrumentation::observer &a_observer )
+        {
+            a_observer.on_release( a_event );
+        }
+    );
+}
+
+/**
+ * @brief Tells the observers that a wrapper is destroyed, once the events of
+ * releases made before are delivered, then erases its name. Observers that
+ * look names up can thus always find the wrapper under its name, either as
+ * live or as retired.
+ */
+inline void
+retire_wrapper(
+    std::uint32_t a_wrapper
+) noexcept
+{
+    auto &state = instrumentation_state::instance();
+
+    if( state.observer_count.load( std::memory_order_relaxed ) != 0 )
+    {
+        const auto name = instrumentation::wrapper_name( a_wrapper );
+
+        wait_for_observer_sections();
+        for_each_observer(
+            [a_wrapper, &name]( instrumentation::observer &a_observer )
+            {
+                a_observer.on_destroy( a_wrapper, name );
+            }
+        );
+    }
+
+    take_wrapper_name( a_wrapper );
+}
+
+/**
+ * @brief A shared lock held by the calling thread.
+ */
+struct shared_hold
+{
+        const void   *mutex;
+        std::uint64_t start_ns;
+        std::uint64_t wait_ns;
+        bool          contended;
+};
+
+inline std::vector<shared_hold> &
+shared_holds() noexcept
+{
+    thread_local std::vector<shared_hold> t_holds;
+    return t_holds;
+}
+
+} // namespace zdm::detail
+
+namespace zdm::instrumentation {
+
+/**
+ * @brief Registers an observer for the events of all instrumented wrappers.
+ *
+ * @return `false` if the maximum number of observers is already registered.
+ */
+inline bool
+add_observer(
+    observer &a_observer
+)
+{
+    auto            &state = detail::instrumentation_state::instance();
+    std::scoped_lock lock( state.observers_mutex );
+
+    for( auto &slot : state.observers )
+    {
+        if( slot.observer.load() == nullptr && !slot.removing )
+        {
+            slot.observer.store( &a_observer );
+            state.observer_count.fetch_add( 1 );
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Unregisters an observer.
+ *
+ * Returns once no other thread is calling into the observer anymore, so it
+ * can be destroyed right after. Only the calls into this observer are
+ * waited for, and its slot is not reused meanwhile, so lock traffic can not
+ * hold it up. It may be called from a callback. Calls into the observer
+ * that are removing it themselves are not waited for.
+ */
+inline void
+remove_observer(
+    observer &a_observer
+)
+{
+    auto &state = detail::instrumentation_state::instance();
+    auto &own   = detail::local_observer_calls();
+
+    std::array<bool, detail::max_instrumentation_observers> removed{};
+
+    {
+        std::scoped_lock lock( state.observers_mutex );
+
+        for( std::size_t i = 0; i < state.observers.size(); ++i )
+        {
+            auto &slot     = state.observers[i];
+            auto *expected = &a_observer;
+
+            if( slot.observer.compare_exchange_strong( expected, nullptr ) )
+            {
+                slot.removing = true;
+                removed[i]    = true;
+                state.observer_count.fetch_sub( 1 );
+            }
+        }
+    }
+
+    for( std::size_t i = 0; i < state.observers.size(); ++i )
+    {
+        auto &slot = state.observers[i];
+
+        if( !removed[i] )
+        {
+            continue;
+        }
+
+        slot.parked.fetch_add( own[i] );
+
+        while( slot.calls.load() != slot.parked.load() )
+        {
+            std::this_thread::yield();
+        }
+
+        slot.parked.fetch_sub( own[i] );
+
+        std::scoped_lock lock( state.observers_mutex );
+        slot.removing = false;
+    }
+}
+
+} // namespace zdm::instrumentation
+
+namespace zdm {
+
+/**
+ * @brief A mutex adapter that times every critical section.
+ *
+ * Every outermost release produces a `zdm::instrumentation::lock_event`, with
+ * the time spent waiting for the lock and the time it was held, which is
+ * passed to the registered `zdm::instrumentation::observer`s after the lock
+ * is released. Nested acquisitions of a recursive `AMutex` are part of the
+ * outermost critical section. Contended, acquire and release events are also
+ * kept by the `zdm::instrumentation::flight_recorder`, and waits and holds are
+ * watched by any running `zdm::instrumentation::lock_watchdog`.
+ *
+ * Each mutex gets a process unique id, which observers use to tell wrappers
+ * apart, and can be given a name through `set_name`. The name is forgotten
+ * when the mutex is destroyed, after `observer::on_destroy`.
+ */
+template <zdm::concepts::lockable AMutex = std::mutex>
+class instrumented_mutex
+{
+    public:
+        instrumented_mutex()
+            : m_id( detail::wrapper_names::instance().next_id.fetch_add( 1 ) )
+        {
+        }
+
+        instrumented_mutex( const instrumented_mutex & )            = delete;
+        instrumented_mutex &operator=( const instrumented_mutex & ) = delete;
+
+        ~instrumented_mutex()
+        {
+            detail::retire_wrapper( m_id );
+        }
+
+        void
+        lock()
+        {
+            const auto start     = instrumentation::now_ns();
+            bool       contended = false;
+
+            if constexpr( requires { m_mutex.try_lock(); } )
+            {
+                if( !m_mutex.try_lock() )
+                {
+                    contended = true;
+                    record_flight(
+                        m_id,
+                        instrumentation::flight_event_kind::contended,
+                        start,
+                        instrumentation::lock_mode::exclusive
+                    );
+                    detail::note_lock_wait(
+                        m_id,
+                        instrumentation::lock_mode::exclusive,
+                        start
+                    );
+                    m_mutex.lock();
+                }
+            }
+            else
+            {
+                m_mutex.lock();
+            }
+
+            acquired( start, contended );
+        }
+
+        bool
+        try_lock()
+            requires requires( AMutex &a_mutex ) { a_mutex.try_lock(); }
+        {
+            const auto start = instrumentation::now_ns();
+
+            if( !m_mutex.try_lock() )
+            {
+                detail::drop_acquisition_site();
+                return false;
+            }
+
+            acquired( start, false );
+            return true;
+        }
+
+        void
+        unlock()
+        {
+            if( --m_depth != 0 )
+            {
+                m_mutex.unlock();
+                return;
+            }
+
+            const auto event = instrumentation::lock_event{
+                .start_ns  = m_start_ns,
+                .wait_ns   = m_wait_ns,
+                .hold_ns   = instrumentation::now_ns() - m_start_ns - m_wait_ns,
+                .thread    = instrumentation::thread_index(),
+                .wrapper   = m_id,
+                .mode      = instrumentation::lock_mode::exclusive,
+                .contended = m_contended,
+            };
+
+            const auto section = pending_release();
+            m_mutex.unlock();
+            released( event );
+        }
+
+        void
+        lock_shared()
+            requires concepts::shared_lockable<AMutex>
+        {
+            const auto start     = instrumentation::now_ns();
+            bool       contended = false;
+
+            if( !m_mutex.try_lock_shared() )
+            {
+                contended = true;
+                record_flight(
+                    m_id,
+                    instrumentation::flight_event_kind::contended,
+                    start,
+                    instrumentation::lock_mode::shared
+                );
+                detail::note_lock_wait(
+                    m_id,
+                    instrumentation::lock_mode::shared,
+                    start
+                );
+                m_mutex.lock_shared();
+            }
+
+            acquired_shared( start, contended );
+        }
+
+        bool
+        try_lock_shared()
+            requires concepts::shared_lockable<AMutex>
+        {
+            const auto start = instrumentation::now_ns();
+
+            if( !m_mutex.try_lock_shared() )
+            {
+                detail::drop_acquisition_site();
+                return false;
+            }
+
+            acquired_shared( start, false );
+            return true;
+        }
+
+        void
+        unlock_shared()
+            requires concepts::shared_lockable<AMutex>
+        {
+            auto &holds = detail::shared_holds();
+            auto  hold  = holds.end();
+
+            while( hold != holds.begin() && ( hold - 1 )->mutex != this )
+            {
+                --hold;
+            }
+
+            if( hold == holds.begin() )
+            {
+                // Not locked through `lock_shared` on this thread, so there
+                // is no critical section to report.
+                m_mutex.unlock_shared();
+                return;
+            }
+
+            --hold;
+
+            const auto event = instrumentation::lock_event{
+                .start_ns  = hold->start_ns,
+                .wait_ns   = hold->wait_ns,
+                .hold_ns   = instrumentation::now_ns() - hold->start_ns
+                         - hold->wait_ns,
+                .thread    = instrumentation::thread_index(),
+                .wrapper   = m_id,
+                .mode      = instrumentation::lock_mode::shared,
+                .contended = hold->contended,
+            };
+
+            holds.erase( hold );
+
+            const auto section = pending_release();
+            m_mutex.unlock_shared();
+            released( event );
+        }
+
+        /**
+         * @brief Sets the site reported by watchdogs for the calling
+         * thread's next lock. Called by `with_lock`. The site is dropped if
+         * the next lock is a `try_lock` that fails.
+         */
+        void
+        set_acquisition_site(
+            const std::source_location &a_site
+        ) noexcept
+        {
+            if( detail::watching_locks() )
+            {
+                detail::pending_acquisition_site() = {
+                    a_site.file_name(),
+                    a_site.function_name(),
+                    a_site.line(),
+                };
+            }
+        }
+
+        /**
+         * @brief The process unique id of this mutex, as found in its
+         * events.
+         */
+        std::uint32_t
+        id() const noexcept
+        {
+            return m_id;
+        }
+
+        std::string
+        name() const
+        {
+            return instrumentation::wrapper_name( m_id );
+        }
+
+        void
+        set_name(
+            std::string_view a_name
+        )
+        {
+            instrumentation::set_wrapper_name( m_id, a_name );
+        }
+
+    private:
+        void
+        acquired(
+            std::uint64_t a_start_ns,
+            bool          a_contended
+        ) noexcept
+        {
+            if( m_depth++ == 0 )
+            {
+                m_start_ns  = a_start_ns;
+                m_wait_ns   = instrumentation::now_ns() - a_start_ns;
+                m_contended = a_contended;
+                record_flight(
+                    m_id,
+                    instrumentation::flight_event_kind::acquire,
+                    m_start_ns + m_wait_ns,
+                    instrumentation::lock_mode::exclusive
+                );
+                detail::note_lock_hold(
+                    m_id,
+                    instrumentation::lock_mode::exclusive,
+                    m_start_ns + m_wait_ns
+                );
+            }
+        }
+
+        void
+        acquired_shared(
+            std::uint64_t a_start_ns,
+            bool          a_contended
+        )
+        {
+            const auto wait_ns = instrumentation::now_ns() - a_start_ns;
+
+            detail::shared_holds().push_back(
+                { this, a_start_ns, wait_ns, a_contended }
+            );
+            record_flight(
+                m_id,
+                instrumentation::flight_event_kind::acquire,
+                a_start_ns + wait_ns,
+                instrumentation::lock_mode::shared
+            );
+            detail::note_lock_hold(
+                m_id,
+                instrumentation::lock_mode::shared,
+                a_start_ns + wait_ns
+            );
+        }
+
+        /**
+         * @brief Enters an observer section before a release, if there are
+         * observers, so that the wrapper is not retired before its event is
+         * delivered.
+         */
+        static std::optional<detail::observer_section>
+        pending_release()
+        {
+            if( detail::instrumentation_state::instance().observer_count.load(
+                    std::memory_order_relaxed
+                )
+                == 0 )
+            {
+                return std::nullopt;
+            }
+
+            return std::optional<detail::observer_section>( std::in_place );
+        }
+
+        /**
+         * @brief Emits a release once the lock is released. Static, as the
+         * mutex may already be destroyed by another thread.
+         */
+        static void
+        released(
+            const instrumentation::lock_event &a_event
+        ) noexcept
+        {
+            record_flight(
+                a_event.wrapper,
+                instrumentation::flight_event_kind::release,
+                a_event.start_ns + a_event.wait_ns + a_event.hold_ns,
+                a_event.mode
+            );
+            detail::note_lock_release( a_event.wrapper );
+            detail::dispatch_release( a_event );
+        }
+
+        static void
+        record_flight(
+            std::uint32_t                      a_wrapper,
+            instrumentation::flight_event_kind a_kind,
+            std::uint64_t                      a_time_ns,
+            instrumentation::lock_mode         a_mode
+        ) noexcept
+        {
+            instrumentation::flight_recorder::record( {
+                .time_ns = a_time_ns,
+                .thread  = instrumentation::thread_index(),
+                .wrapper = a_wrapper,
+                .kind    = a_kind,
+                .mode    = a_mode,
+            } );
+        }
+
+        AMutex        m_mutex;
+        std::uint32_t m_id;
+        std::uint32_t m_depth     = 0;
+        std::uint64_t m_start_ns  = 0;
+        std::uint64_t m_wait_ns   = 0;
+        bool          m_contended = false;
+};
+
+template <class AMutex>
+struct mutex_traits<instrumented_mutex<AMutex>>
+{
+        using mutex_type  = instrumented_mutex<AMutex>;
+        using unique_lock = std::unique_lock<mutex_type>;
+        using shared_lock = std::conditional_t<
+            concepts::shared_lockable<AMutex>,
+            std::shared_lock<mutex_type>,
+            std::unique_lock<mutex_type>>;
+};
+
+template <class T>
+using instrumented_lock_wrapper = basic_lock_wrapper<T, instrumented_mutex<>>;
+
+template <class T>
+using instrumented_shared_lock_wrapper
+    = basic_lock_wrapper<T, instrumented_mutex<std::shared_mutex>>;
+
+template <class T>
+using instrumented_recursive_lock_wrapper
+    = basic_lock_wrapper<T, instrumented_mutex<std::recursive_mutex>>;
+
+} // namespace zdm
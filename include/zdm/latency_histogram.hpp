@@ -0,0 +1,226 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace zdm {
+
+class concurrent_histogram;
+
+/**
+ * @brief A fixed size log-linear histogram in the style of HdrHistogram.
+ *
+ * Values are unsigned integers, typically nanoseconds. Every power of two
+ * range is split into `sub_bucket_count` linear buckets, so any recorded value
+ * is reported with a relative error below `1 / sub_bucket_count` (about 3%)
+ * over the whole 64 bit range, without any allocation.
+ *
+ * The histogram is not synchronized. Record into one histogram per thread and
+ * `merge` them for reporting, or use `zdm::concurrent_histogram`.
+ */
+class latency_histogram
+{
+    public:
+        static constexpr unsigned    sub_bucket_bits  = 5;
+        static constexpr std::size_t sub_bucket_count = std::size_t{ 1 }
+                                                     << sub_bucket_bits;
+        static constexpr std::size_t bucket_count
+            = ( 64 - sub_bucket_bits + 1 ) * sub_bucket_count;
+
+        /**
+         * @brief The index of the bucket holding a value.
+         */
+        static constexpr std::size_t
+        bucket_index(
+            std::uint64_t a_value
+        ) noexcept
+        {
+            if( a_value < sub_bucket_count )
+            {
+                return static_cast<std::size_t>( a_value );
+            }
+
+            const auto exponent
+                = static_cast<unsigned>( std::bit_width( a_value ) ) - 1;
+            const auto shift = exponent - sub_bucket_bits;
+            const auto mantissa
+                = static_cast<std::size_t>( a_value >> shift );
+
+            return ( shift + 1 ) * sub_bucket_count
+                 + ( mantissa - sub_bucket_count );
+        }
+
+        /**
+         * @brief The largest value that lands in a bucket.
+         */
+        static constexpr std::uint64_t
+        bucket_upper_bound(
+            std::size_t a_index
+        ) noexcept
+        {
+            if( a_index < sub_bucket_count )
+            {
+                return a_index;
+            }
+
+            const auto shift    = a_index / sub_bucket_count - 1;
+            const auto mantissa = std::uint64_t{ a_index % sub_bucket_count }
+                                + sub_bucket_count;
+
+            // Wraps around to the maximum for the very last bucket.
+            return ( ( mantissa + 1 ) << shift ) - 1;
+        }
+
+        void
+        record(
+            std::uint64_t a_value,
+            std::uint64_t a_count = 1
+        ) noexcept
+        {
+            m_buckets[bucket_index( a_value )] += a_count;
+            m_count += a_count;
+            m_sum += a_value * a_count;
+            m_min = std::min( m_min, a_value );
+            m_max = std::max( m_max, a_value );
+        }
+
+        void
+        merge(
+            const latency_histogram &a_other
+        ) noexcept
+        {
+            for( std::size_t i = 0; i < bucket_count; ++i )
+            {
+                m_buckets[i] += a_other.m_buckets[i];
+            }
+
+            m_count += a_other.m_count;
+            m_sum += a_other.m_sum;
+            m_min = std::min( m_min, a_other.m_min );
+            m_max = std::max( m_max, a_other.m_max );
+        }
+
+        void
+        reset() noexcept
+        {
+            *this = latency_histogram{};
+        }
+
+        std::uint64_t
+        count() const noexcept
+        {
+            return m_count;
+        }
+
+        std::uint64_t
+        sum() const noexcept
+        {
+            return m_sum;
+        }
+
+        std::uint64_t
+        min() const noexcept
+        {
+            return m_count ? m_min : 0;
+        }
+
+        std::uint64_t
+        max() const noexcept
+        {
+            return m_max;
+        }
+
+        double
+        mean() const noexcept
+        {
+            return m_count ? static_cast<double>( m_sum )
+                                 / static_cast<double>( m_count )
+                           : 0.0;
+        }
+
+        std::uint64_t
+        bucket(
+            std::size_t a_index
+        ) const noexcept
+        {
+            return m_buckets[a_index];
+        }
+
+        /**
+         * @brief The value below or at which the given percentage of the
+         * recorded values fall.
+         *
+         * @param a_percentile A percentile in `[0, 100]`, such as `99.9`.
+         * @return The upper bound of the bucket holding that value, clamped
+         * to the recorded maximum.
+         */
+        std::uint64_t
+        value_at_percentile(
+            double a_percentile
+        ) const noexcept
+        {
+            if( m_count == 0 )
+            {
+                return 0;
+            }
+
+            const auto clamped = std::clamp( a_percentile, 0.0, 100.0 );
+            const auto rank    = std::max<std::uint64_t>(
+                1,
+                static_cast<std::uint64_t>(
+                    clamped / 100.0 * static_cast<double>( m_count ) + 0.5
+                )
+            );
+
+            std::uint64_t seen = 0;
+
+            for( std::size_t i = 0; i < bucket_count; ++i )
+            {
+                seen += m_buckets[i];
+
+                if( seen >= rank )
+                {
+                    return std::min( bucket_upper_bound( i ), m_max );
+                }
+            }
+
+            return m_max;
+        }
+
+    private:
+        friend class concurrent_histogram;
+
+        std::array<std::uint64_t, bucket_count> m_buckets{};
+        std::uint64_t                           m_count = 0;
+        std::uint64_t                           m_sum   = 0;
+        std::uint64_t m_min = std::numeric_limits<std::uint64_t>::max();
+        std::uint64_t m_max = 0;
+};
+
+} // namespace zdm
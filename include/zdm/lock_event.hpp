@@ -0,0 +1,159 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace zdm::instrumentation {
+
+enum class lock_mode : std::uint8_t
+{
+    exclusive,
+    shared
+};
+
+/**
+ * @brief One completed critical section of an instrumented wrapper.
+ *
+ * Times are in nanoseconds. `start_ns` is the time at which the acquisition
+ * began, so the lock was held from `start_ns + wait_ns` for `hold_ns`.
+ */
+struct lock_event
+{
+        std::uint64_t start_ns  = 0;
+        std::uint64_t wait_ns   = 0;
+        std::uint64_t hold_ns   = 0;
+        std::uint32_t thread    = 0;
+        std::uint32_t wrapper   = 0;
+        lock_mode     mode      = lock_mode::exclusive;
+        bool          contended = false;
+
+        friend bool
+        operator==( const lock_event &, const lock_event & ) = default;
+};
+
+/**
+ * @brief The clock used for lock events, in nanoseconds.
+ */
+inline std::uint64_t
+now_ns() noexcept
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        )
+            .count()
+    );
+}
+
+/**
+ * @brief A small, dense identifier of the calling thread.
+ */
+inline std::uint32_t
+thread_index() noexcept
+{
+    static std::atomic<std::uint32_t> s_next{ 0 };
+    thread_local const std::uint32_t  t_index
+        = s_next.fetch_add( 1, std::memory_order_relaxed );
+    return t_index;
+}
+
+} // namespace zdm::instrumentation
+
+namespace zdm::detail {
+
+/**
+ * @brief The ids and names of instrumented wrappers. Ids are never reused,
+ * and names are erased when their wrapper is destroyed.
+ */
+struct wrapper_names
+{
+        std::atomic<std::uint32_t>                     next_id{ 1 };
+        std::mutex                                     mutex;
+        std::unordered_map<std::uint32_t, std::string> names;
+
+        static wrapper_names &
+        instance()
+        {
+            static wrapper_names s_names;
+            return s_names;
+        }
+};
+
+} // namespace zdm::detail
+
+namespace zdm::instrumentation {
+
+/**
+ * @brief The name given to an instrumented wrapper, or an empty string.
+ */
+inline std::string
+wrapper_name(
+    std::uint32_t a_wrapper
+)
+{
+    auto            &state = detail::wrapper_names::instance();
+    std::scoped_lock lock( state.mutex );
+    const auto       found = state.names.find( a_wrapper );
+    return found == state.names.end() ? std::string() : found->second;
+}
+
+inline void
+set_wrapper_name(
+    std::uint32_t    a_wrapper,
+    std::string_view a_name
+)
+{
+    auto            &state = detail::wrapper_names::instance();
+    std::scoped_lock lock( state.mutex );
+    state.names.insert_or_assign( a_wrapper, std::string( a_name ) );
+}
+
+} // namespace zdm::instrumentation
+
+namespace zdm::detail {
+
+/**
+ * @brief Erases the name of a wrapper that is being destroyed.
+ *
+ * @return The name it had, or an empty string.
+ */
+inline std::string
+take_wrapper_name(
+    std::uint32_t a_wrapper
+)
+{
+    auto            &state = wrapper_names::instance();
+    std::scoped_lock lock( state.mutex );
+    auto             node = state.names.extract( a_wrapper );
+    return node.empty() ? std::string() : std::move( node.mapped() );
+}
+
+} // namespace zdm::detail
@@ -0,0 +1,434 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <zdm/detail/thread_local_cache.hpp>
+#include <zdm/instrumented_mutex.hpp>
+#include <zdm/lock_wrapper.hpp>
+
+namespace zdm::instrumentation {
+
+/**
+ * @brief A recorded sequence of lock events together with the names of the
+ * wrappers they refer to.
+ */
+struct lock_trace
+{
+        std::vector<std::pair<std::uint32_t, std::string>> wrappers;
+        /** @brief Ordered by `start_ns`. */
+        std::vector<lock_event>                            events;
+};
+
+} // namespace zdm::instrumentation
+
+namespace zdm::detail {
+
+inline constexpr std::array<char, 8> trace_magic{ 'Z', 'D', 'M', 'T',
+                                                  'R', 'A', 'C', 'E' };
+inline constexpr std::uint8_t        trace_version = 1;
+
+inline constexpr std::uint8_t trace_shared_flag    = 1;
+inline constexpr std::uint8_t trace_contended_flag = 2;
+
+/**
+ * @brief The longest wrapper name stored in a trace. Longer names are cut,
+ * and traces claiming longer ones are rejected before allocating.
+ */
+inline constexpr std::size_t trace_max_name_size = 4096;
+
+inline void
+write_varint(
+    std::ostream &a_stream,
+    std::uint64_t a_value
+)
+{
+    while( a_value >= 0x80 )
+    {
+        a_stream.put( static_cast<char>( ( a_value & 0x7F ) | 0x80 ) );
+        a_value >>= 7;
+    }
+
+    a_stream.put( static_cast<char>( a_value ) );
+}
+
+inline std::uint64_t
+read_varint(
+    std::istream &a_stream
+)
+{
+    std::uint64_t value = 0;
+
+    for( unsigned shift = 0; shift < 64; shift += 7 )
+    {
+        const auto byte = a_stream.get();
+
+        if( byte == std::istream::traits_type::eof() )
+        {
+            throw std::runtime_error( "zdm: truncated lock trace" );
+        }
+
+        value |= static_cast<std::uint64_t>( byte & 0x7F ) << shift;
+
+        if( ( byte & 0x80 ) == 0 )
+        {
+            return value;
+        }
+    }
+
+    throw std::runtime_error( "zdm: malformed lock trace" );
+}
+
+} // namespace zdm::detail
+
+namespace zdm::instrumentation {
+
+/**
+ * @brief Writes a trace in the compact binary trace format.
+ *
+ * The format is a magic string and version byte, followed by LEB128 encoded
+ * integers: the wrapper table (id, name length, name bytes), then the events
+ * with their start time stored as the difference to the previous event.
+ */
+inline void
+write_trace(
+    std::ostream     &a_stream,
+    const lock_trace &a_trace
+)
+{
+    a_stream.write( detail::trace_magic.data(), detail::trace_magic.size() );
+    a_stream.put( static_cast<char>( detail::trace_version ) );
+
+    detail::write_varint( a_stream, a_trace.wrappers.size() );
+
+    for( const auto &[id, name] : a_trace.wrappers )
+    {
+        const auto size = std::min( name.size(), detail::trace_max_name_size );
+
+        detail::write_varint( a_stream, id );
+        detail::write_varint( a_stream, size );
+        a_stream.write( name.data(), static_cast<std::streamsize>( size ) );
+    }
+
+    detail::write_varint( a_stream, a_trace.events.size() );
+
+    std::uint64_t previous_start = 0;
+
+    for( const auto &event : a_trace.events )
+    {
+        std::uint8_t flags = 0;
+
+        if( event.mode == lock_mode::shared )
+        {
+            flags |= detail::trace_shared_flag;
+        }
+
+        if( event.contended )
+        {
+            flags |= detail::trace_contended_flag;
+        }
+
+        detail::write_varint( a_stream, event.start_ns - previous_start );
+        detail::write_varint( a_stream, event.wait_ns );
+        detail::write_varint( a_stream, event.hold_ns );
+        detail::write_varint( a_stream, event.thread );
+        detail::write_varint( a_stream, event.wrapper );
+        a_stream.put( static_cast<char>( flags ) );
+
+        previous_start = event.start_ns;
+    }
+}
+
+/**
+ * @brief Reads a trace written by `write_trace`.
+ *
+ * @throws std::runtime_error if the stream does not hold a valid trace.
+ */
+inline lock_trace
+read_trace(
+    std::istream &a_stream
+)
+{
+    std::array<char, 8> magic{};
+    a_stream.read( magic.data(), magic.size() );
+
+    if( !a_stream || magic != detail::trace_magic
+        || a_stream.get() != detail::trace_version )
+    {
+        throw std::runtime_error( "zdm: not a lock trace" );
+    }
+
+    lock_trace trace;
+
+    const auto wrapper_count = detail::read_varint( a_stream );
+
+    for( std::uint64_t i = 0; i < wrapper_count; ++i )
+    {
+        const auto id
+            = static_cast<std::uint32_t>( detail::read_varint( a_stream ) );
+        const auto size = detail::read_varint( a_stream );
+
+        if( size > detail::trace_max_name_size )
+        {
+            throw std::runtime_error( "zdm: malformed lock trace" );
+        }
+
+        std::string name( static_cast<std::size_t>( size ), '\0' );
+
+        if( !a_stream.read(
+                name.data(),
+                static_cast<std::streamsize>( name.size() )
+            ) )
+        {
+            throw std::runtime_error( "zdm: truncated lock trace" );
+        }
+
+        trace.wrappers.emplace_back( id, std::move( name ) );
+    }
+
+    const auto    event_count = detail::read_varint( a_stream );
+    std::uint64_t start       = 0;
+
+    for( std::uint64_t i = 0; i < event_count; ++i )
+    {
+        lock_event event;
+        start += detail::read_varint( a_stream );
+
+        event.start_ns = start;
+        event.wait_ns  = detail::read_varint( a_stream );
+        event.hold_ns  = detail::read_varint( a_stream );
+        event.thread
+            = static_cast<std::uint32_t>( detail::read_varint( a_stream ) );
+        event.wrapper
+            = static_cast<std::uint32_t>( detail::read_varint( a_stream ) );
+
+        const auto flags = a_stream.get();
+
+        if( flags == std::istream::traits_type::eof() )
+        {
+            throw std::runtime_error( "zdm: truncated lock trace" );
+        }
+
+        event.mode      = ( flags & detail::trace_shared_flag )
+                            ? lock_mode::shared
+                            : lock_mode::exclusive;
+        event.contended = ( flags & detail::trace_contended_flag ) != 0;
+        trace.events.push_back( event );
+    }
+
+    return trace;
+}
+
+/**
+ * @brief Records the events of all instrumented wrappers while started.
+ *
+ * Every thread appends to a buffer of its own, so recording does not add a
+ * lock of its own to the instrumented critical sections.
+ */
+class trace_recorder : public observer
+{
+    public:
+        trace_recorder() = default;
+
+        trace_recorder( const trace_recorder & )            = delete;
+        trace_recorder &operator=( const trace_recorder & ) = delete;
+
+        ~trace_recorder() override
+        {
+            stop();
+        }
+
+        void
+        start()
+        {
+            if( !m_started.exchange( true ) )
+            {
+                add_observer( *this );
+            }
+        }
+
+        void
+        stop()
+        {
+            if( m_started.exchange( false ) )
+            {
+                remove_observer( *this );
+            }
+        }
+
+        /**
+         * @brief Stops recording and returns the events recorded so far.
+         *
+         * Wrappers destroyed while recording keep the name they had. Those
+         * destroyed after `stop` and before `take` are unnamed.
+         */
+        lock_trace
+        take()
+        {
+            stop();
+
+            lock_trace                        trace;
+            std::unordered_set<std::uint32_t> wrappers;
+            name_map                          retired;
+
+            m_buffers.with_lock(
+                [&]( buffer_list& a_buffers )
+                {
+                    for( auto &buffer : a_buffers )
+                    {
+                        trace.events.insert(
+                            trace.events.end(),
+                            buffer->begin(),
+                            buffer->end()
+                        );
+                        buffer->clear();
+                    }
+                }
+            );
+            m_retired_names.with_lock(
+                [&retired]( name_map& a_names )
+                {
+                    retired.swap( a_names );
+                }
+            );
+
+            std::ranges::stable_sort( trace.events, {}, &lock_event::start_ns );
+
+            for( const auto &event : trace.events )
+            {
+                if( wrappers.insert( event.wrapper ).second )
+                {
+                    const auto found = retired.find( event.wrapper );
+
+                    trace.wrappers.emplace_back(
+                        event.wrapper,
+                        found == retired.end() ? wrapper_name( event.wrapper )
+                                               : std::move( found->second )
+                    );
+                }
+            }
+
+            return trace;
+        }
+
+        /**
+         * @brief The number of events lost because a buffer could not grow.
+         */
+        std::uint64_t
+        dropped() const noexcept
+        {
+            return m_dropped.load( std::memory_order_relaxed );
+        }
+
+        void
+        on_release(
+            const lock_event &a_event
+        ) noexcept override
+        {
+            try
+            {
+                local_buffer().push_back( a_event );
+            }
+            catch( ... )
+            {
+                m_dropped.fetch_add( 1, std::memory_order_relaxed );
+            }
+        }
+
+        void
+        on_destroy(
+            std::uint32_t      a_wrapper,
+            const std::string &a_name
+        ) noexcept override
+        {
+            if( a_name.empty() )
+            {
+                return;
+            }
+
+            try
+            {
+                m_retired_names.with_lock(
+                    [&]( name_map& a_names )
+                    {
+                        a_names.insert_or_assign( a_wrapper, a_name );
+                    }
+                );
+            }
+            catch( ... )
+            {
+                // The wrapper is exported unnamed.
+            }
+        }
+
+    private:
+        using buffer_list
+            = std::vector<std::unique_ptr<std::vector<lock_event>>>;
+        using buffer_cache
+            = zdm::detail::thread_local_cache<std::vector<lock_event>>;
+        using name_map = std::unordered_map<std::uint32_t, std::string>;
+
+        /**
+         * @brief The calling thread's buffer, created on its first event.
+         */
+        std::vector<lock_event> &
+        local_buffer()
+        {
+            return m_local.local(
+                [this]()
+                {
+                    return m_buffers.with_lock(
+                        []( buffer_list& a_buffers )
+                        {
+                            return a_buffers
+                                .emplace_back(
+                                    std::make_unique<std::vector<lock_event>>()
+                                )
+                                .get();
+                        }
+                    );
+                }
+            );
+        }
+
+        buffer_cache                   m_local;
+        std::atomic<bool>              m_started{ false };
+        std::atomic<std::uint64_t>     m_dropped{ 0 };
+        zdm::lock_wrapper<buffer_list> m_buffers;
+        zdm::lock_wrapper<name_map>    m_retired_names;
+};
+
+} // namespace zdm::instrumentation
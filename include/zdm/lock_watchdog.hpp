@@ -0,0 +1,603 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <zdm/lock_event.hpp>
+
+namespace zdm::instrumentation {
+
+enum class lock_phase : std::uint8_t
+{
+    waiting,
+    holding
+};
+
+/**
+ * @brief Where a lock was requested, as captured by `with_lock`. Empty for
+ * locks taken without going through a wrapper.
+ */
+struct acquisition_site
+{
+        const char   *file     = "";
+        const char   *function = "";
+        std::uint32_t line     = 0;
+};
+
+/**
+ * @brief A wait or hold that exceeded the threshold of a
+ * `zdm::instrumentation::lock_watchdog`.
+ */
+struct slow_lock_report
+{
+        /** @brief The wrapper's name, or an empty string. */
+        std::string              name;
+        std::uint32_t            wrapper = 0;
+        std::uint32_t            thread  = 0;
+        lock_phase               phase   = lock_phase::holding;
+        lock_mode                mode    = lock_mode::exclusive;
+        /** @brief How long the wait or hold had lasted when detected. */
+        std::chrono::nanoseconds elapsed{ 0 };
+        acquisition_site         site;
+};
+
+} // namespace zdm::instrumentation
+
+namespace zdm::detail {
+
+/**
+ * @brief The locks one thread is waiting for or holding.
+ *
+ * Only the owning thread writes, using the same sequence protocol as
+ * `flight_ring`, so watchdogs can read the slots from their own thread.
+ * Every write gets a new sequence number, which watchdogs use to report a
+ * wait or hold only once. Tables are never freed and are reused once their
+ * thread exits.
+ */
+struct activity_table
+{
+        static constexpr std::size_t capacity = 8;
+
+        struct slot
+        {
+                std::atomic<std::uint64_t> sequence{ 0 };
+                /** @brief Wrapper id, phase + 1 and mode; 0 when free. */
+                std::atomic<std::uint64_t> state{ 0 };
+                std::atomic<std::uint64_t> start_ns{ 0 };
+                std::atomic<const char *>  file{ "" };
+                std::atomic<const char *>  function{ "" };
+                std::atomic<std::uint32_t> line{ 0 };
+        };
+
+        struct snapshot
+        {
+                std::uint64_t                     sequence = 0;
+                std::uint32_t                     wrapper  = 0;
+                instrumentation::lock_phase       phase{};
+                instrumentation::lock_mode        mode{};
+                std::uint64_t                     start_ns = 0;
+                instrumentation::acquisition_site site;
+        };
+
+        std::array<slot, capacity> slots;
+        std::uint64_t              generation = 0;
+        std::size_t                active     = 0;
+        std::atomic<std::uint32_t> thread{ 0 };
+        std::atomic<bool>          in_use{ true };
+        activity_table            *next = nullptr;
+
+        static constexpr std::uint64_t
+        encode(
+            std::uint32_t               a_wrapper,
+            instrumentation::lock_phase a_phase,
+            instrumentation::lock_mode  a_mode
+        ) noexcept
+        {
+            return std::uint64_t{ a_wrapper } << 32
+                 | ( static_cast<std::uint64_t>( a_phase ) + 1 ) << 8
+                 | static_cast<std::uint64_t>( a_mode );
+        }
+
+        /**
+         * @brief The most recent slot of `a_wrapper` in `a_phase`, or null.
+         */
+        slot *
+        find(
+            std::uint32_t               a_wrapper,
+            instrumentation::lock_phase a_phase
+        ) noexcept
+        {
+            const auto wanted = encode( a_wrapper, a_phase, {} ) >> 8;
+
+            for( auto entry = slots.rbegin(); entry != slots.rend(); ++entry )
+            {
+                if( entry->state.load( std::memory_order_relaxed ) >> 8
+                    == wanted )
+                {
+                    return &*entry;
+                }
+            }
+
+            return nullptr;
+        }
+
+        slot *
+        find_free() noexcept
+        {
+            for( auto &entry : slots )
+            {
+                if( entry.state.load( std::memory_order_relaxed ) == 0 )
+                {
+                    return &entry;
+                }
+            }
+
+            return nullptr;
+        }
+
+        void
+        write(
+            slot                                    &a_slot,
+            std::uint64_t                            a_state,
+            std::uint64_t                            a_start_ns,
+            const instrumentation::acquisition_site &a_site
+        ) noexcept
+        {
+            a_slot.sequence.store( 0, std::memory_order_relaxed );
+            std::atomic_thread_fence( std::memory_order_release );
+            a_slot.state.store( a_state, std::memory_order_relaxed );
+            a_slot.start_ns.store( a_start_ns, std::memory_order_relaxed );
+            a_slot.file.store( a_site.file, std::memory_order_relaxed );
+            a_slot.function.store( a_site.function, std::memory_order_relaxed );
+            a_slot.line.store( a_site.line, std::memory_order_relaxed );
+            a_slot.sequence.store( ++generation, std::memory_order_release );
+        }
+
+        bool
+        read(
+            const slot &a_slot,
+            snapshot   &a_snapshot
+        ) const noexcept
+        {
+            const auto sequence
+                = a_slot.sequence.load( std::memory_order_acquire );
+
+            if( sequence == 0 )
+            {
+                return false;
+            }
+
+            const auto state = a_slot.state.load( std::memory_order_relaxed );
+
+            a_snapshot.start_ns
+                = a_slot.start_ns.load( std::memory_order_relaxed );
+            a_snapshot.site = {
+                a_slot.file.load( std::memory_order_relaxed ),
+                a_slot.function.load( std::memory_order_relaxed ),
+                a_slot.line.load( std::memory_order_relaxed ),
+            };
+
+            std::atomic_thread_fence( std::memory_order_acquire );
+
+            if( state == 0
+                || a_slot.sequence.load( std::memory_order_relaxed )
+                       != sequence )
+            {
+                return false;
+            }
+
+            a_snapshot.sequence = sequence;
+            a_snapshot.wrapper  = static_cast<std::uint32_t>( state >> 32 );
+            a_snapshot.phase    = static_cast<instrumentation::lock_phase>(
+                ( ( state >> 8 ) & 0xFF ) - 1
+            );
+            a_snapshot.mode
+                = static_cast<instrumentation::lock_mode>( state & 0xFF );
+            return true;
+        }
+};
+
+inline std::atomic<activity_table *> activity_tables{ nullptr };
+
+/**
+ * @brief The number of running watchdogs. Activity is only tracked while
+ * there is at least one.
+ */
+inline std::atomic<std::uint32_t> lock_watchdogs{ 0 };
+
+inline bool
+watching_locks() noexcept
+{
+    return lock_watchdogs.load( std::memory_order_relaxed ) != 0;
+}
+
+inline activity_table *
+claim_activity_table()
+{
+    for( auto *table = activity_tables.load( std::memory_order_acquire ); table;
+         table       = table->next )
+    {
+        bool expected = false;
+
+        if( table->in_use.compare_exchange_strong( expected, true ) )
+        {
+            return table;
+        }
+    }
+
+    auto *table = new activity_table;
+    table->next = activity_tables.load( std::memory_order_relaxed );
+
+    while( !activity_tables.compare_exchange_weak(
+        table->next,
+        table,
+        std::memory_order_release,
+        std::memory_order_relaxed
+    ) )
+    {
+    }
+
+    return table;
+}
+
+/**
+ * @brief The calling thread's table, or null if it never tracked a lock.
+ */
+inline activity_table *&
+current_activity_table() noexcept
+{
+    thread_local activity_table *t_table = nullptr;
+    return t_table;
+}
+
+/**
+ * @brief The calling thread's table, claimed on first use and released when
+ * the thread exits.
+ */
+inline activity_table &
+local_activity_table()
+{
+    struct handle
+    {
+            activity_table *table = claim_activity_table();
+
+            ~handle()
+            {
+                for( auto &entry : table->slots )
+                {
+                    if( entry.state.load( std::memory_order_relaxed ) != 0 )
+                    {
+                        table->write( entry, 0, 0, {} );
+                    }
+                }
+
+                table->active = 0;
+                current_activity_table() = nullptr;
+                table->in_use.store( false, std::memory_order_release );
+            }
+    };
+
+    thread_local handle t_handle;
+    t_handle.table->thread.store(
+        instrumentation::thread_index(),
+        std::memory_order_relaxed
+    );
+    current_activity_table() = t_handle.table;
+    return *t_handle.table;
+}
+
+/**
+ * @brief The site passed to the next lock of the calling thread.
+ */
+inline instrumentation::acquisition_site &
+pending_acquisition_site() noexcept
+{
+    thread_local instrumentation::acquisition_site t_site;
+    return t_site;
+}
+
+inline instrumentation::acquisition_site
+take_acquisition_site() noexcept
+{
+    return std::exchange( pending_acquisition_site(), {} );
+}
+
+/**
+ * @brief Forgets the pending site of a `try_lock` that failed, so that it is
+ * not reported for the thread's next, unrelated lock.
+ */
+inline void
+drop_acquisition_site() noexcept
+{
+    pending_acquisition_site() = {};
+}
+
+/**
+ * @brief Records that the calling thread starts waiting for `a_wrapper`.
+ */
+inline void
+note_lock_wait(
+    std::uint32_t              a_wrapper,
+    instrumentation::lock_mode a_mode,
+    std::uint64_t              a_start_ns
+)
+{
+    if( !watching_locks() )
+    {
+        return;
+    }
+
+    auto &table = local_activity_table();
+
+    if( auto *entry = table.find_free() )
+    {
+        table.write(
+            *entry,
+            activity_table::encode(
+                a_wrapper,
+                instrumentation::lock_phase::waiting,
+                a_mode
+            ),
+            a_start_ns,
+            pending_acquisition_site()
+        );
+        ++table.active;
+    }
+}
+
+/**
+ * @brief Records that the calling thread acquired `a_wrapper`, turning its
+ * wait, if any, into a hold. Consumes the pending acquisition site.
+ */
+inline void
+note_lock_hold(
+    std::uint32_t              a_wrapper,
+    instrumentation::lock_mode a_mode,
+    std::uint64_t              a_start_ns
+)
+{
+    const auto *current = current_activity_table();
+
+    if( !watching_locks() && ( current == nullptr || current->active == 0 ) )
+    {
+        return;
+    }
+
+    auto &table = local_activity_table();
+    auto  site  = take_acquisition_site();
+    auto *entry
+        = table.find( a_wrapper, instrumentation::lock_phase::waiting );
+
+    if( entry != nullptr )
+    {
+        site = {
+            entry->file.load( std::memory_order_relaxed ),
+            entry->function.load( std::memory_order_relaxed ),
+            entry->line.load( std::memory_order_relaxed ),
+        };
+    }
+    else if( ( entry = table.find_free() ) != nullptr )
+    {
+        ++table.active;
+    }
+    else
+    {
+        return;
+    }
+
+    table.write(
+        *entry,
+        activity_table::encode(
+            a_wrapper,
+            instrumentation::lock_phase::holding,
+            a_mode
+        ),
+        a_start_ns,
+        site
+    );
+}
+
+/**
+ * @brief Records that the calling thread released `a_wrapper`. Runs even
+ * without a watchdog, so no stale hold outlives a stopped watchdog.
+ */
+inline void
+note_lock_release(
+    std::uint32_t a_wrapper
+) noexcept
+{
+    auto *table = current_activity_table();
+
+    if( table == nullptr || table->active == 0 )
+    {
+        return;
+    }
+
+    if( auto *entry
+        = table->find( a_wrapper, instrumentation::lock_phase::holding ) )
+    {
+        table->write( *entry, 0, 0, {} );
+        --table->active;
+    }
+}
+
+} // namespace zdm::detail
+
+namespace zdm::instrumentation {
+
+/**
+ * @brief Reports waits and holds of instrumented wrappers that last longer
+ * than a threshold, while they are still in progress.
+ *
+ * While a watchdog runs, instrumented mutexes record what every thread is
+ * waiting for and holding, along with the `with_lock` call that requested
+ * the lock. A background thread scans these records every `a_interval` and
+ * passes each wait or hold that exceeded the threshold to the callback, once
+ * per wait or hold. The callback runs on the watchdog's thread and must not
+ * lock the wrapper it is told about.
+ *
+ * Each thread tracks up to 8 locks at once; deeper nesting is not watched.
+ */
+class lock_watchdog
+{
+    public:
+        using callback_type = std::function<void( const slow_lock_report & )>;
+
+        /**
+         * @param a_threshold How long a wait or hold may last before it is
+         * reported.
+         * @param a_callback Called with every slow wait or hold.
+         * @param a_interval How often to scan, by default a quarter of the
+         * threshold.
+         */
+        lock_watchdog(
+            std::chrono::nanoseconds a_threshold,
+            callback_type            a_callback,
+            std::chrono::nanoseconds a_interval = {}
+        )
+            : m_threshold( a_threshold )
+            , m_interval(
+                  a_interval > std::chrono::nanoseconds::zero()
+                      ? a_interval
+                      : std::max<std::chrono::nanoseconds>(
+                            a_threshold / 4,
+                            std::chrono::microseconds( 100 )
+                        )
+              )
+            , m_callback( std::move( a_callback ) )
+        {
+            detail::lock_watchdogs.fetch_add( 1 );
+            m_thread = std::thread(
+                [this]()
+                {
+                    run();
+                }
+            );
+        }
+
+        lock_watchdog( const lock_watchdog & )            = delete;
+        lock_watchdog &operator=( const lock_watchdog & ) = delete;
+
+        ~lock_watchdog()
+        {
+            {
+                std::scoped_lock lock( m_mutex );
+                m_stopping = true;
+            }
+
+            m_condition.notify_all();
+            m_thread.join();
+            detail::lock_watchdogs.fetch_sub( 1 );
+        }
+
+    private:
+        void
+        run()
+        {
+            std::unique_lock lock( m_mutex );
+
+            while( !m_condition.wait_for(
+                lock,
+                m_interval,
+                [this]()
+                {
+                    return m_stopping;
+                }
+            ) )
+            {
+                lock.unlock();
+                scan();
+                lock.lock();
+            }
+        }
+
+        void
+        scan()
+        {
+            const auto now = now_ns();
+
+            for( auto *table
+                 = detail::activity_tables.load( std::memory_order_acquire );
+                 table;
+                 table = table->next )
+            {
+                for( const auto &entry : table->slots )
+                {
+                    detail::activity_table::snapshot snapshot;
+
+                    if( !table->read( entry, snapshot )
+                        || now < snapshot.start_ns
+                        || std::chrono::nanoseconds( now - snapshot.start_ns )
+                               < m_threshold )
+                    {
+                        continue;
+                    }
+
+                    auto &reported = m_reported[&entry];
+
+                    if( reported == snapshot.sequence )
+                    {
+                        continue;
+                    }
+
+                    reported = snapshot.sequence;
+                    m_callback( {
+                        .name    = wrapper_name( snapshot.wrapper ),
+                        .wrapper = snapshot.wrapper,
+                        .thread  = table->thread.load(),
+                        .phase   = snapshot.phase,
+                        .mode    = snapshot.mode,
+                        .elapsed = std::chrono::nanoseconds(
+                            now - snapshot.start_ns
+                        ),
+                        .site    = snapshot.site,
+                    } );
+                }
+            }
+        }
+
+        std::chrono::nanoseconds m_threshold;
+        std::chrono::nanoseconds m_interval;
+        callback_type            m_callback;
+        std::unordered_map<const detail::activity_table::slot *, std::uint64_t>
+                                m_reported;
+        std::mutex              m_mutex;
+        std::condition_variable m_condition;
+        bool                    m_stopping = false;
+        std::thread             m_thread;
+};
+
+} // namespace zdm::instrumentation
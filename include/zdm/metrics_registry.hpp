@@ -0,0 +1,536 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <zdm/detail/replace_file.hpp>
+#include <zdm/detail/thread_local_cache.hpp>
+#include <zdm/instrumented_mutex.hpp>
+#include <zdm/lock_wrapper.hpp>
+
+namespace zdm::detail {
+
+/**
+ * @brief A histogram with the fixed bucket bounds exported to Prometheus,
+ * from 100ns to 2.5s.
+ */
+struct prometheus_histogram
+{
+        static constexpr std::array<std::uint64_t, 23> bounds_ns{
+            100,           250,           500,
+            1'000,         2'500,         5'000,
+            10'000,        25'000,        50'000,
+            100'000,       250'000,       500'000,
+            1'000'000,     2'500'000,     5'000'000,
+            10'000'000,    25'000'000,    50'000'000,
+            100'000'000,   250'000'000,   500'000'000,
+            1'000'000'000, 2'500'000'000,
+        };
+
+        /** @brief Per bucket counts, the last one past every bound. */
+        std::array<std::uint64_t, bounds_ns.size() + 1> counts{};
+        std::uint64_t                                   sum_ns = 0;
+
+        void
+        record(
+            std::uint64_t a_value_ns
+        ) noexcept
+        {
+            std::size_t index = 0;
+
+            while( index < bounds_ns.size() && a_value_ns > bounds_ns[index] )
+            {
+                ++index;
+            }
+
+            ++counts[index];
+            sum_ns += a_value_ns;
+        }
+
+        void
+        merge(
+            const prometheus_histogram &a_other
+        ) noexcept
+        {
+            for( std::size_t i = 0; i < counts.size(); ++i )
+            {
+                counts[i] += a_other.counts[i];
+            }
+
+            sum_ns += a_other.sum_ns;
+        }
+};
+
+struct wrapper_metrics
+{
+        /** @brief Indexed by `zdm::instrumentation::lock_mode`. */
+        std::array<std::uint64_t, 2> acquisitions{};
+        std::uint64_t                contended = 0;
+        prometheus_histogram         wait;
+        prometheus_histogram         hold;
+
+        void
+        merge(
+            const wrapper_metrics &a_other
+        ) noexcept
+        {
+            acquisitions[0] += a_other.acquisitions[0];
+            acquisitions[1] += a_other.acquisitions[1];
+            contended       += a_other.contended;
+            wait.merge( a_other.wait );
+            hold.merge( a_other.hold );
+        }
+};
+
+inline void
+write_prometheus_label(
+    std::ostream    &a_stream,
+    std::string_view a_value
+)
+{
+    for( const char character : a_value )
+    {
+        switch( character )
+        {
+        case '\\':
+            a_stream << "\\\\";
+            break;
+        case '"':
+            a_stream << "\\\"";
+            break;
+        case '\n':
+            a_stream << "\\n";
+            break;
+        default:
+            a_stream << character;
+        }
+    }
+}
+
+inline void
+write_prometheus_seconds(
+    std::ostream &a_stream,
+    std::uint64_t a_ns
+)
+{
+    char text[32];
+    std::snprintf(
+        text,
+        sizeof( text ),
+        "%.9g",
+        static_cast<double>( a_ns ) / 1e9
+    );
+    a_stream << text;
+}
+
+inline void
+write_prometheus_histogram(
+    std::ostream               &a_stream,
+    std::string_view            a_metric,
+    std::string_view            a_wrapper,
+    const prometheus_histogram &a_histogram
+)
+{
+    std::uint64_t cumulative = 0;
+
+    for( std::size_t i = 0; i < a_histogram.counts.size(); ++i )
+    {
+        cumulative += a_histogram.counts[i];
+        a_stream << a_metric << "_bucket{wrapper=\"";
+        write_prometheus_label( a_stream, a_wrapper );
+        a_stream << "\",le=\"";
+
+        if( i < prometheus_histogram::bounds_ns.size() )
+        {
+            write_prometheus_seconds(
+                a_stream,
+                prometheus_histogram::bounds_ns[i]
+            );
+        }
+        else
+        {
+            a_stream << "+Inf";
+        }
+
+        a_stream << "\"} " << cumulative << '\n';
+    }
+
+    a_stream << a_metric << "_sum{wrapper=\"";
+    write_prometheus_label( a_stream, a_wrapper );
+    a_stream << "\"} ";
+    write_prometheus_seconds( a_stream, a_histogram.sum_ns );
+    a_stream << '\n' << a_metric << "_count{wrapper=\"";
+    write_prometheus_label( a_stream, a_wrapper );
+    a_stream << "\"} " << cumulative << '\n';
+}
+
+} // namespace zdm::detail
+
+namespace zdm::instrumentation {
+
+/**
+ * @brief Aggregates the events of instrumented wrappers while started and
+ * renders them in the Prometheus text exposition format.
+ *
+ * Only named wrappers are exported, labelled with their name, so short lived
+ * unnamed wrappers do not create new series. Wrappers sharing a name are
+ * exported as one. For each wrapper, the registry exports:
+ * - `zdm_lock_acquisitions_total`, by lock mode.
+ * - `zdm_lock_contended_total`, the acquisitions that had to wait.
+ * - `zdm_lock_contention_ratio`, contended over all acquisitions.
+ * - `zdm_lock_wait_seconds` and `zdm_lock_hold_seconds` histograms.
+ *
+ * Like `zdm::instrumentation::trace_recorder`, every thread aggregates into
+ * a shard of its own, which is only contended while rendering.
+ */
+class metrics_registry : public observer
+{
+    public:
+        metrics_registry() = default;
+
+        metrics_registry( const metrics_registry & )            = delete;
+        metrics_registry &operator=( const metrics_registry & ) = delete;
+
+        ~metrics_registry() override
+        {
+            stop();
+        }
+
+        void
+        start()
+        {
+            if( !m_started.exchange( true ) )
+            {
+                add_observer( *this );
+            }
+        }
+
+        void
+        stop()
+        {
+            if( m_started.exchange( false ) )
+            {
+                remove_observer( *this );
+            }
+        }
+
+        void
+        render(
+            std::ostream &a_stream
+        ) const
+        {
+            constexpr std::array<const char *, 2> mode_names{
+                "exclusive",
+                "shared",
+            };
+            const auto metrics = collect();
+
+            a_stream << "# HELP zdm_lock_acquisitions_total Lock acquisitions."
+                        "\n# TYPE zdm_lock_acquisitions_total counter\n";
+
+            for( const auto &[name, wrapper] : metrics )
+            {
+                for( std::size_t mode = 0; mode < 2; ++mode )
+                {
+                    a_stream << "zdm_lock_acquisitions_total{wrapper=\"";
+                    detail::write_prometheus_label( a_stream, name );
+                    a_stream << "\",mode=\"" << mode_names[mode] << "\"} "
+                             << wrapper.acquisitions[mode] << '\n';
+                }
+            }
+
+            a_stream << "# HELP zdm_lock_contended_total Lock acquisitions "
+                        "that had to wait.\n"
+                        "# TYPE zdm_lock_contended_total counter\n";
+
+            for( const auto &[name, wrapper] : metrics )
+            {
+                a_stream << "zdm_lock_contended_total{wrapper=\"";
+                detail::write_prometheus_label( a_stream, name );
+                a_stream << "\"} " << wrapper.contended << '\n';
+            }
+
+            a_stream << "# HELP zdm_lock_contention_ratio Contended over all "
+                        "lock acquisitions.\n"
+                        "# TYPE zdm_lock_contention_ratio gauge\n";
+
+            for( const auto &[name, wrapper] : metrics )
+            {
+                const auto total
+                    = wrapper.acquisitions[0] + wrapper.acquisitions[1];
+
+                a_stream << "zdm_lock_contention_ratio{wrapper=\"";
+                detail::write_prometheus_label( a_stream, name );
+                a_stream << "\"} "
+                         << ( total == 0 ? 0.0
+                                         : static_cast<double>(
+                                               wrapper.contended
+                                           ) / static_cast<double>( total ) )
+                         << '\n';
+            }
+
+            a_stream << "# HELP zdm_lock_wait_seconds Time spent waiting for "
+                        "locks.\n"
+                        "# TYPE zdm_lock_wait_seconds histogram\n";
+
+            for( const auto &[name, wrapper] : metrics )
+            {
+                detail::write_prometheus_histogram(
+                    a_stream,
+                    "zdm_lock_wait_seconds",
+                    name,
+                    wrapper.wait
+                );
+            }
+
+            a_stream << "# HELP zdm_lock_hold_seconds Time locks were held.\n"
+                        "# TYPE zdm_lock_hold_seconds histogram\n";
+
+            for( const auto &[name, wrapper] : metrics )
+            {
+                detail::write_prometheus_histogram(
+                    a_stream,
+                    "zdm_lock_hold_seconds",
+                    name,
+                    wrapper.hold
+                );
+            }
+        }
+
+        std::string
+        render() const
+        {
+            std::ostringstream stream;
+            render( stream );
+            return stream.str();
+        }
+
+        /**
+         * @brief Renders the metrics to a file through
+         * `zdm::detail::replace_file`, so that scrapers never read a partial
+         * file.
+         *
+         * @return `false` if the file could not be written.
+         */
+        bool
+        write_file(
+            const std::filesystem::path &a_path
+        ) const
+        {
+            return detail::replace_file(
+                a_path,
+                std::ios::out,
+                [this]( std::ofstream& a_stream )
+                {
+                    render( a_stream );
+                }
+            );
+        }
+
+        /**
+         * @brief The number of events lost because a shard could not grow.
+         */
+        std::uint64_t
+        dropped() const noexcept
+        {
+            return m_dropped.load( std::memory_order_relaxed );
+        }
+
+        void
+        on_release(
+            const lock_event &a_event
+        ) noexcept override
+        {
+            try
+            {
+                local_shard().with_lock(
+                    [&a_event]( shard_map& a_shard )
+                    {
+                        auto &metrics = a_shard[a_event.wrapper];
+
+                        ++metrics.acquisitions[static_cast<std::size_t>(
+                            a_event.mode
+                        )];
+                        metrics.contended += a_event.contended ? 1 : 0;
+                        metrics.wait.record( a_event.wait_ns );
+                        metrics.hold.record( a_event.hold_ns );
+                    }
+                );
+            }
+            catch( ... )
+            {
+                m_dropped.fetch_add( 1, std::memory_order_relaxed );
+            }
+        }
+
+        /**
+         * @brief Drops the entries of a destroyed wrapper from every shard.
+         * The metrics of a named wrapper are kept, merged under its name
+         * while the shards are still locked, so `collect` never misses them.
+         */
+        void
+        on_destroy(
+            std::uint32_t      a_wrapper,
+            const std::string &a_name
+        ) noexcept override
+        {
+            try
+            {
+                m_shards.with_lock(
+                    [&]( const shard_list& a_shards )
+                    {
+                        detail::wrapper_metrics retired;
+
+                        for( const auto &local : a_shards )
+                        {
+                            local->with_lock(
+                                [&]( shard_map& a_shard )
+                                {
+                                    auto node = a_shard.extract( a_wrapper );
+
+                                    if( !node.empty() )
+                                    {
+                                        retired.merge( node.mapped() );
+                                    }
+                                }
+                            );
+                        }
+
+                        if( !a_name.empty() )
+                        {
+                            m_retired.with_lock(
+                                [&]( retired_map& a_retired )
+                                {
+                                    a_retired[a_name].merge( retired );
+                                }
+                            );
+                        }
+                    }
+                );
+            }
+            catch( ... )
+            {
+                m_dropped.fetch_add( 1, std::memory_order_relaxed );
+            }
+        }
+
+    private:
+        using shard_map
+            = std::unordered_map<std::uint32_t, detail::wrapper_metrics>;
+        using shard      = zdm::lock_wrapper<shard_map>;
+        using shard_list = std::vector<std::unique_ptr<shard>>;
+
+        using retired_map = std::map<std::string, detail::wrapper_metrics>;
+
+        /**
+         * @brief The calling thread's shard, created on its first event.
+         */
+        shard &
+        local_shard()
+        {
+            return m_local.local(
+                [this]()
+                {
+                    return m_shards.with_lock(
+                        []( shard_list& a_shards )
+                        {
+                            return a_shards
+                                .emplace_back( std::make_unique<shard>() )
+                                .get();
+                        }
+                    );
+                }
+            );
+        }
+
+        /**
+         * @brief The metrics of every named wrapper, merged by name.
+         *
+         * Reads the shards, the retired metrics and the names under the
+         * shard list lock, which `on_destroy` holds while it moves a
+         * wrapper's metrics from the former to the latter. Names are only
+         * erased after `on_destroy`, so every wrapper is counted once.
+         */
+        std::map<std::string, detail::wrapper_metrics>
+        collect() const
+        {
+            return m_shards.with_lock(
+                [this]( const shard_list& a_shards )
+                {
+                    shard_map merged;
+
+                    for( const auto &local : a_shards )
+                    {
+                        local->with_lock(
+                            [&merged]( const shard_map& a_shard )
+                            {
+                                for( const auto &[id, metrics] : a_shard )
+                                {
+                                    merged[id].merge( metrics );
+                                }
+                            }
+                        );
+                    }
+
+                    auto named = m_retired.with_lock(
+                        []( const retired_map& a_retired )
+                        {
+                            return a_retired;
+                        }
+                    );
+
+                    for( const auto &[id, metrics] : merged )
+                    {
+                        if( auto name = wrapper_name( id ); !name.empty() )
+                        {
+                            named[std::move( name )].merge( metrics );
+                        }
+                    }
+
+                    return named;
+                }
+            );
+        }
+
+        detail::thread_local_cache<shard> m_local;
+        std::atomic<bool>                 m_started{ false };
+        std::atomic<std::uint64_t>        m_dropped{ 0 };
+        zdm::lock_wrapper<shard_list>     m_shards;
+        zdm::lock_wrapper<retired_map>    m_retired;
+};
+
+} // namespace zdm::instrumentation
@@ -0,0 +1,399 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <zdm/detail/thread_local_cache.hpp>
+#include <zdm/lock_wrapper.hpp>
+
+namespace zdm {
+
+/**
+ * @brief A pool of reusable objects, such as large buffers, shared between
+ * threads.
+ *
+ * `acquire` hands out an object in a `handle`, which gives it back to the
+ * pool when destroyed. Every thread keeps up to `cache_capacity` returned
+ * objects in a cache of its own, whose lock is only contended when another
+ * thread steals from it. Past that, objects move in batches through a shared
+ * overflow list, so threads that only release objects feed the threads that
+ * only acquire them without taking the shared lock for each object.
+ *
+ * Objects are handed out as they were returned; reset them before use if
+ * needed. Handles must not outlive their pool.
+ */
+template <class T>
+class object_pool
+{
+    private:
+        using object_list = std::vector<std::unique_ptr<T>>;
+        using cache       = zdm::lock_wrapper<object_list>;
+        using cache_list  = std::vector<std::unique_ptr<cache>>;
+
+    public:
+        using factory_type = std::function<std::unique_ptr<T>()>;
+
+        /**
+         * @brief Owns an object of the pool and returns it on destruction.
+         */
+        class handle
+        {
+            public:
+                handle() = default;
+
+                handle( handle &&a_other ) noexcept = default;
+
+                handle &
+                operator=(
+                    handle &&a_other
+                ) noexcept
+                {
+                    if( this != &a_other )
+                    {
+                        reset();
+                        m_pool   = a_other.m_pool;
+                        m_object = std::move( a_other.m_object );
+                    }
+
+                    return *this;
+                }
+
+                ~handle()
+                {
+                    reset();
+                }
+
+                T &
+                operator*() const noexcept
+                {
+                    return *m_object;
+                }
+
+                T *
+                operator->() const noexcept
+                {
+                    return m_object.get();
+                }
+
+                T *
+                get() const noexcept
+                {
+                    return m_object.get();
+                }
+
+                explicit
+                operator bool() const noexcept
+                {
+                    return m_object != nullptr;
+                }
+
+                /**
+                 * @brief Returns the object to the pool early.
+                 */
+                void
+                reset() noexcept
+                {
+                    if( m_object )
+                    {
+                        m_pool->release( std::move( m_object ) );
+                    }
+                }
+
+            private:
+                friend class object_pool;
+
+                handle(
+                    object_pool        &a_pool,
+                    std::unique_ptr<T> &&a_object
+                ) noexcept
+                    : m_pool( &a_pool )
+                    , m_object( std::move( a_object ) )
+                {
+                }
+
+                object_pool       *m_pool = nullptr;
+                std::unique_ptr<T> m_object;
+        };
+
+        /**
+         * @param a_cache_capacity The number of objects each thread keeps,
+         * at least one.
+         * @param a_factory Creates objects when the pool is empty, by
+         * default with `std::make_unique<T>()`.
+         */
+        explicit object_pool(
+            std::size_t  a_cache_capacity = 8,
+            factory_type a_factory        = {}
+        )
+            : m_cache_capacity( std::max<std::size_t>( a_cache_capacity, 1 ) )
+            , m_factory( std::move( a_factory ) )
+        {
+        }
+
+        object_pool( const object_pool & )            = delete;
+        object_pool &operator=( const object_pool & ) = delete;
+
+        /**
+         * @brief An object from the calling thread's cache, the overflow
+         * list or another thread's cache, in that order, or a new one.
+         */
+        handle
+        acquire()
+        {
+            auto &local  = local_cache();
+            auto  object = local.with_lock(
+                []( object_list& a_cache )
+                {
+                    return take_back( a_cache );
+                }
+            );
+
+            if( !object )
+            {
+                object = refill( local );
+            }
+
+            if( !object )
+            {
+                object = steal();
+            }
+
+            if( !object )
+            {
+                object = m_factory ? m_factory() : std::make_unique<T>();
+                m_created.fetch_add( 1, std::memory_order_relaxed );
+            }
+
+            return handle( *this, std::move( object ) );
+        }
+
+        /**
+         * @brief The number of objects the pool has created.
+         */
+        std::uint64_t
+        created() const noexcept
+        {
+            return m_created.load( std::memory_order_relaxed );
+        }
+
+    private:
+        static std::unique_ptr<T>
+        take_back(
+            object_list &a_objects
+        ) noexcept
+        {
+            if( a_objects.empty() )
+            {
+                return nullptr;
+            }
+
+            auto object = std::move( a_objects.back() );
+            a_objects.pop_back();
+            return object;
+        }
+
+        /**
+         * @brief Moves the last `a_count` objects of `a_from` into a list.
+         */
+        static object_list
+        take_batch(
+            object_list &a_from,
+            std::size_t  a_count
+        )
+        {
+            const auto first = a_from.end()
+                             - static_cast<std::ptrdiff_t>(
+                                   std::min( a_count, a_from.size() )
+                             );
+
+            object_list batch(
+                std::make_move_iterator( first ),
+                std::make_move_iterator( a_from.end() )
+            );
+            a_from.erase( first, a_from.end() );
+            return batch;
+        }
+
+        /**
+         * @brief The number of objects moved at once between a cache and
+         * the overflow list.
+         */
+        std::size_t
+        batch_size() const noexcept
+        {
+            return ( m_cache_capacity + 1 ) / 2;
+        }
+
+        /**
+         * @brief The calling thread's cache, created on its first use.
+         */
+        cache &
+        local_cache()
+        {
+            return m_local.local(
+                [this]()
+                {
+                    object_list objects;
+                    objects.reserve( m_cache_capacity );
+
+                    auto created
+                        = std::make_unique<cache>( std::move( objects ) );
+
+                    return m_caches.with_lock(
+                        [&created]( cache_list& a_caches )
+                        {
+                            return a_caches.emplace_back( std::move( created ) )
+                                .get();
+                        }
+                    );
+                }
+            );
+        }
+
+        /**
+         * @brief Moves a batch from the overflow list into the empty cache
+         * of the calling thread, and returns one of its objects.
+         */
+        std::unique_ptr<T>
+        refill(
+            cache &a_local
+        )
+        {
+            auto batch = m_overflow.with_lock(
+                [this]( object_list& a_overflow )
+                {
+                    return take_batch( a_overflow, batch_size() );
+                }
+            );
+            auto object = take_back( batch );
+
+            if( !batch.empty() )
+            {
+                a_local.with_lock(
+                    [&batch]( object_list& a_cache )
+                    {
+                        std::move(
+                            batch.begin(),
+                            batch.end(),
+                            std::back_inserter( a_cache )
+                        );
+                    }
+                );
+            }
+
+            return object;
+        }
+
+        /**
+         * @brief An object from the cache of another thread, such as one
+         * that stopped acquiring. Busy caches are skipped.
+         */
+        std::unique_ptr<T>
+        steal()
+        {
+            return m_caches.with_lock(
+                []( cache_list& a_caches ) -> std::unique_ptr<T>
+                {
+                    for( auto &other : a_caches )
+                    {
+                        auto object = other->try_with_lock(
+                            []( object_list& a_cache )
+                            {
+                                return take_back( a_cache );
+                            }
+                        );
+
+                        if( object && *object )
+                        {
+                            return std::move( *object );
+                        }
+                    }
+
+                    return nullptr;
+                }
+            );
+        }
+
+        /**
+         * @brief Keeps a returned object in the calling thread's cache,
+         * spilling a batch to the overflow list when the cache is full. The
+         * object is destroyed if it cannot be kept.
+         */
+        void
+        release(
+            std::unique_ptr<T> &&a_object
+        ) noexcept
+        {
+            try
+            {
+                auto spilled = local_cache().with_lock(
+                    [this, &a_object]( object_list& a_cache )
+                    {
+                        object_list batch;
+
+                        if( a_cache.size() >= m_cache_capacity )
+                        {
+                            batch = take_batch( a_cache, batch_size() );
+                        }
+
+                        a_cache.push_back( std::move( a_object ) );
+                        return batch;
+                    }
+                );
+
+                if( !spilled.empty() )
+                {
+                    m_overflow.with_lock(
+                        [&spilled]( object_list& a_overflow )
+                        {
+                            std::move(
+                                spilled.begin(),
+                                spilled.end(),
+                                std::back_inserter( a_overflow )
+                            );
+                        }
+                    );
+                }
+            }
+            catch( ... )
+            {
+            }
+        }
+
+        detail::thread_local_cache<cache> m_local;
+        const std::size_t                 m_cache_capacity;
+        const factory_type                m_factory;
+        std::atomic<std::uint64_t>        m_created{ 0 };
+        zdm::lock_wrapper<cache_list>     m_caches;
+        zdm::lock_wrapper<object_list>    m_overflow;
+};
+
+} // namespace zdm
@@ -0,0 +1,430 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <source_location>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <zdm/lock_wrapper.hpp>
+#include <zdm/shared_lock_wrapper.hpp>
+#include <zdm/thread_pool.hpp>
+
+namespace zdm {
+
+/**
+ * @brief A lock wrapper that notifies subscribers of changes.
+ *
+ * Every mutating `with_lock` counts as a change. Subscribers are called
+ * after the lock is released, never inside the critical section, with the
+ * number of changes made so far. Changes made while a notification is
+ * pending or being delivered are coalesced into a single notification, so a
+ * burst of changes notifies once or twice rather than once per change.
+ *
+ * Notifications are delivered one at a time, either by the thread that made
+ * the change or, when constructed with a `zdm::thread_pool`, on the pool.
+ * Without a pool, the first thread to change the object during a delivery
+ * waits for it to end and then delivers once more, covering its own change
+ * and every change made while it waited. Other threads return right away,
+ * so a `with_lock` call waits for at most one delivery and makes at most one
+ * of its own, plus those caused by subscribers changing the object. The
+ * destructor blocks until the last notification has been delivered.
+ *
+ * Exceptions thrown by a subscriber are discarded, since the change has
+ * already been made: the remaining subscribers are still called, and the
+ * subscriber is called again on the next change.
+ */
+template <class AContainedType, zdm::concepts::lockable AMutexType>
+class basic_observable_wrapper
+{
+    public:
+        using callback_type = std::function<void( std::uint64_t )>;
+
+        basic_observable_wrapper() = default;
+
+        explicit basic_observable_wrapper(
+            AContainedType &&a_contained
+        )
+            : m_wrapper( std::forward<AContainedType>( a_contained ) )
+        {
+        }
+
+        /**
+         * @brief Delivers notifications on `a_pool`.
+         */
+        explicit basic_observable_wrapper(
+            thread_pool &a_pool
+        )
+            : m_pool( &a_pool )
+        {
+        }
+
+        basic_observable_wrapper(
+            thread_pool     &a_pool,
+            AContainedType &&a_contained
+        )
+            : m_pool( &a_pool )
+            , m_wrapper( std::forward<AContainedType>( a_contained ) )
+        {
+        }
+
+        basic_observable_wrapper( const basic_observable_wrapper & ) = delete;
+        basic_observable_wrapper &
+        operator=( const basic_observable_wrapper & ) = delete;
+
+        ~basic_observable_wrapper()
+        {
+            std::unique_lock lock( m_delivery_mutex );
+            m_idle.wait(
+                lock,
+                [this]()
+                {
+                    return !m_delivering && !m_waiting;
+                }
+            );
+        }
+
+        /**
+         * @copydoc basic_lock_wrapper::with_lock
+         *
+         * Subscribers are notified once the function has returned and the
+         * lock is released.
+         */
+        inline auto
+        with_lock(
+            concepts::unary_reference_function<AContainedType> auto
+                                       &&a_function,
+            const std::source_location &a_site
+            = std::source_location::current()
+        ) -> decltype( a_function( std::declval<AContainedType &>() ) )
+        {
+            using result_type
+                = decltype( a_function( std::declval<AContainedType &>() ) );
+
+            if constexpr( std::is_void_v<result_type> )
+            {
+                m_wrapper.with_lock(
+                    std::forward<decltype( a_function )>( a_function ),
+                    a_site
+                );
+                changed();
+            }
+            else
+            {
+                decltype( auto ) result = m_wrapper.with_lock(
+                    std::forward<decltype( a_function )>( a_function ),
+                    a_site
+                );
+                changed();
+                return std::forward<result_type>( result );
+            }
+        }
+
+        /**
+         * @copydoc basic_lock_wrapper::with_lock
+         */
+        inline auto
+        with_lock(
+            concepts::unary_const_reference_function<AContainedType> auto
+                                       &&a_function,
+            const std::source_location &a_site
+            = std::source_location::current()
+        ) const
+            -> decltype( a_function( std::declval<const AContainedType &>() ) )
+        {
+            return m_wrapper.with_lock(
+                std::forward<decltype( a_function )>( a_function ),
+                a_site
+            );
+        }
+
+        /**
+         * @brief Registers a callback for changes.
+         *
+         * @return An id for `unsubscribe`.
+         */
+        std::uint64_t
+        subscribe(
+            callback_type a_callback
+        )
+        {
+            std::scoped_lock lock( m_subscribers_mutex );
+
+            auto subscribers = std::make_shared<subscriber_list>(
+                m_subscribers ? *m_subscribers : subscriber_list{}
+            );
+            const auto id = ++m_last_id;
+
+            subscribers->emplace_back( id, std::move( a_callback ) );
+            m_subscribers = std::move( subscribers );
+            return id;
+        }
+
+        /**
+         * @brief Removes a callback. A notification already being delivered
+         * may still call it.
+         */
+        void
+        unsubscribe(
+            std::uint64_t a_id
+        )
+        {
+            std::scoped_lock lock( m_subscribers_mutex );
+
+            if( !m_subscribers )
+            {
+                return;
+            }
+
+            auto subscribers = std::make_shared<subscriber_list>();
+
+            for( const auto &subscriber : *m_subscribers )
+            {
+                if( subscriber.first != a_id )
+                {
+                    subscribers->push_back( subscriber );
+                }
+            }
+
+            m_subscribers = std::move( subscribers );
+        }
+
+        /**
+         * @brief The number of changes made so far.
+         */
+        std::uint64_t
+        version() const noexcept
+        {
+            return m_version.load( std::memory_order_acquire );
+        }
+
+    private:
+        using subscriber_list
+            = std::vector<std::pair<std::uint64_t, callback_type>>;
+
+        /**
+         * @brief Counts a change and delivers a notification.
+         *
+         * While a delivery is under way, `m_pending` marks that another one
+         * must follow. On a pool, the running task submits it. Without a
+         * pool, the first other thread to change the object waits for the
+         * delivery to end and makes the next one itself, and changes made by
+         * subscribers are delivered again by the delivering thread.
+         */
+        void
+        changed()
+        {
+            m_version.fetch_add( 1, std::memory_order_acq_rel );
+
+            std::unique_lock lock( m_delivery_mutex );
+
+            if( m_delivering || m_waiting )
+            {
+                if( m_pool != nullptr || m_waiting
+                    || m_delivery_thread == std::this_thread::get_id() )
+                {
+                    m_pending = true;
+                    return;
+                }
+
+                m_waiting = true;
+                m_idle.wait(
+                    lock,
+                    [this]()
+                    {
+                        return !m_delivering;
+                    }
+                );
+                m_waiting = false;
+            }
+
+            m_delivering = true;
+            m_pending    = false;
+
+            if( m_pool == nullptr )
+            {
+                m_delivery_thread = std::this_thread::get_id();
+                lock.unlock();
+                deliver_here();
+                return;
+            }
+
+            lock.unlock();
+
+            try
+            {
+                m_pool->submit(
+                    [this]()
+                    {
+                        deliver();
+                    }
+                );
+            }
+            catch( ... )
+            {
+                std::scoped_lock failed( m_delivery_mutex );
+                m_delivering = false;
+                m_pending    = false;
+                m_idle.notify_all();
+                throw;
+            }
+        }
+
+        /**
+         * @brief Calls every subscriber on the calling thread, again for as
+         * long as they change the object themselves. Changes by other threads
+         * are left to the thread waiting to deliver next.
+         */
+        void
+        deliver_here() noexcept
+        {
+            for( ;; )
+            {
+                notify_subscribers();
+
+                std::scoped_lock lock( m_delivery_mutex );
+
+                if( !m_pending || m_waiting )
+                {
+                    m_delivering      = false;
+                    m_delivery_thread = {};
+                    m_idle.notify_all();
+                    return;
+                }
+
+                m_pending = false;
+            }
+        }
+
+        /**
+         * @brief Calls every subscriber on the pool, then submits a new task
+         * if changes were made meanwhile, so that a busy wrapper cannot
+         * starve the pool. Delivers again on this task if that fails.
+         */
+        void
+        deliver() noexcept
+        {
+            for( ;; )
+            {
+                {
+                    // Changes made so far are covered by this delivery.
+                    std::scoped_lock lock( m_delivery_mutex );
+                    m_pending = false;
+                }
+
+                notify_subscribers();
+
+                {
+                    std::scoped_lock lock( m_delivery_mutex );
+
+                    if( !m_pending )
+                    {
+                        m_delivering = false;
+                        m_idle.notify_all();
+                        return;
+                    }
+
+                    m_pending = false;
+                }
+
+                try
+                {
+                    m_pool->submit(
+                        [this]()
+                        {
+                            deliver();
+                        }
+                    );
+                    return;
+                }
+                catch( ... )
+                {
+                    // Deliver again on this task instead.
+                }
+            }
+        }
+
+        /**
+         * @brief Calls every subscriber with the current version, skipping
+         * over those that throw.
+         */
+        void
+        notify_subscribers() noexcept
+        {
+            std::shared_ptr<const subscriber_list> subscribers;
+
+            {
+                std::scoped_lock lock( m_subscribers_mutex );
+                subscribers = m_subscribers;
+            }
+
+            if( !subscribers )
+            {
+                return;
+            }
+
+            const auto current = version();
+
+            for( const auto &subscriber : *subscribers )
+            {
+                try
+                {
+                    subscriber.second( current );
+                }
+                catch( ... )
+                {
+                    // The change is already made; see the class description.
+                }
+            }
+        }
+
+        thread_pool                                   *m_pool = nullptr;
+        basic_lock_wrapper<AContainedType, AMutexType> m_wrapper;
+        std::atomic<std::uint64_t>                     m_version{ 0 };
+        std::mutex                                     m_subscribers_mutex;
+        std::shared_ptr<const subscriber_list>         m_subscribers;
+        std::uint64_t                                  m_last_id = 0;
+        std::mutex                                     m_delivery_mutex;
+        std::condition_variable                        m_idle;
+        std::thread::id                                m_delivery_thread;
+        bool                                           m_delivering = false;
+        bool                                           m_pending    = false;
+        bool                                           m_waiting    = false;
+};
+
+template <class T>
+using observable_wrapper = basic_observable_wrapper<T, std::mutex>;
+
+template <class T>
+using shared_observable_wrapper
+    = basic_observable_wrapper<T, std::shared_mutex>;
+
+} // namespace zdm
@@ -0,0 +1,441 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <source_location>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <zdm/lock_wrapper.hpp>
+#include <zdm/thread_pool.hpp>
+
+namespace zdm {
+
+/**
+ * @brief Tuning for `zdm::parallel_with_lock`.
+ */
+struct parallel_policy
+{
+        /**
+         * @brief The pool supplying the helper threads,
+         * `thread_pool::shared()` when null.
+         */
+        thread_pool *pool = nullptr;
+
+        /**
+         * @brief The number of elements a thread claims at a time.
+         */
+        std::size_t chunk_size = 256;
+
+        /**
+         * @brief The maximum number of threads, including the caller. Zero
+         * means the pool size plus the caller.
+         */
+        std::size_t max_threads = 0;
+
+        /**
+         * @brief How many passes over the busy elements of a chunk use
+         * `try_with_lock` before falling back to a blocking `with_lock`. Zero
+         * locks every element blocking right away.
+         */
+        std::size_t try_passes = 2;
+};
+
+namespace detail {
+
+template <class AWrapper, class AFunction>
+void
+visit_chunk(
+    std::span<AWrapper *const> a_chunk,
+    AFunction                 &a_function,
+    std::size_t                a_try_passes
+)
+{
+    std::vector<AWrapper *> busy( a_chunk.begin(), a_chunk.end() );
+    std::vector<AWrapper *> still_busy;
+
+    for( std::size_t pass = 0; pass < a_try_passes && !busy.empty(); ++pass )
+    {
+        still_busy.clear();
+
+        for( auto *wrapper : busy )
+        {
+            if( !wrapper->try_with_lock( a_function ) )
+            {
+                still_busy.push_back( wrapper );
+            }
+        }
+
+        busy.swap( still_busy );
+    }
+
+    for( auto *wrapper : busy )
+    {
+        wrapper->with_lock( a_function );
+    }
+}
+
+/**
+ * @brief The partitions of a `zdm::parallel_with_lock` or
+ * `zdm::with_lock_parallel` call, shared with the helper tasks so that
+ * helpers starting after the call returned find no work left instead of a
+ * dangling state.
+ */
+struct partition_progress
+{
+        explicit partition_progress(
+            std::size_t a_count
+        ) noexcept
+            : count( a_count )
+        {
+        }
+
+        const std::size_t        count;
+        std::atomic<std::size_t> next{ 0 };
+        std::atomic<std::size_t> finished{ 0 };
+        std::atomic<bool>        failed{ false };
+        std::mutex               error_mutex;
+        std::exception_ptr       error;
+
+        void
+        fail(
+            std::exception_ptr a_error
+        )
+        {
+            failed.store( true );
+
+            std::scoped_lock lock( error_mutex );
+
+            if( !error )
+            {
+                error = std::move( a_error );
+            }
+        }
+
+        void
+        wait() noexcept
+        {
+            for( auto done = finished.load(); done != count;
+                 done      = finished.load() )
+            {
+                finished.wait( done );
+            }
+        }
+};
+
+/**
+ * @brief Claims and runs partitions until none are left. `a_run` is only
+ * used while a claimed partition is unfinished, which the caller waits for.
+ */
+template <class ARun>
+void
+run_partitions(
+    partition_progress &a_progress,
+    ARun               *a_run
+)
+{
+    for( ;; )
+    {
+        const auto partition = a_progress.next.fetch_add( 1 );
+
+        if( partition >= a_progress.count )
+        {
+            return;
+        }
+
+        if( !a_progress.failed.load() )
+        {
+            try
+            {
+                ( *a_run )( partition );
+            }
+            catch( ... )
+            {
+                a_progress.fail( std::current_exception() );
+            }
+        }
+
+        if( a_progress.finished.fetch_add( 1 ) + 1 == a_progress.count )
+        {
+            a_progress.finished.notify_all();
+        }
+    }
+}
+
+/**
+ * @brief Runs `a_run` for every partition below `a_count` on the caller and
+ * up to `a_workers - 1` helper tasks, then rethrows the first exception.
+ *
+ * The caller runs every partition no helper has claimed, so it only waits for
+ * partitions that are already running. Helpers that never start, because
+ * every pool thread is busy or the caller is itself a task of the pool, do
+ * not hold it up.
+ */
+template <class ARun>
+void
+run_parallel(
+    thread_pool &a_pool,
+    std::size_t  a_workers,
+    std::size_t  a_count,
+    ARun        &a_run
+)
+{
+    auto       progress = std::make_shared<partition_progress>( a_count );
+    const auto helpers  = std::min( a_workers, a_count );
+
+    try
+    {
+        for( std::size_t i = 1; i < helpers; ++i )
+        {
+            a_pool.submit(
+                [progress, run_partition = &a_run]()
+                {
+                    run_partitions( *progress, run_partition );
+                }
+            );
+        }
+    }
+    catch( ... )
+    {
+        // Fewer helpers: the caller runs what they would have.
+    }
+
+    run_partitions( *progress, &a_run );
+    progress->wait();
+
+    if( progress->error )
+    {
+        std::rethrow_exception( progress->error );
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Runs a function on every wrapper of a range, in parallel.
+ *
+ * The range is split into chunks that the caller and helper threads from the
+ * pool claim one at a time, so threads that finish early keep taking work from
+ * the ones that are slowed down. The caller runs every chunk no helper has
+ * claimed, so it is safe to call from a task of the same pool. Each wrapper is
+ * only locked while the function runs on it. Wrappers whose lock is busy are
+ * skipped and revisited at the end of the chunk, and only locked blocking
+ * after `parallel_policy::try_passes` failed attempts.
+ *
+ * The function is shared between threads and must be safe to call
+ * concurrently on different wrappers. If it throws, no further chunks are
+ * started and the first exception is rethrown once all threads are done.
+ *
+ * @param a_range A sized range of wrappers.
+ * @param a_function A callable taking a reference or const reference to the
+ * contained object. Its return value is discarded.
+ * @param a_policy Threading and retry options.
+ */
+template <std::ranges::sized_range ARange, class AFunction>
+void
+parallel_with_lock(
+    ARange         &&a_range,
+    AFunction      &&a_function,
+    parallel_policy  a_policy = {}
+)
+{
+    using wrapper_type
+        = std::remove_reference_t<std::ranges::range_reference_t<ARange>>;
+
+    std::vector<wrapper_type *> wrappers;
+    wrappers.reserve( std::ranges::size( a_range ) );
+
+    for( auto &wrapper : a_range )
+    {
+        wrappers.push_back( &wrapper );
+    }
+
+    if( wrappers.empty() )
+    {
+        return;
+    }
+
+    auto &pool       = a_policy.pool ? *a_policy.pool : thread_pool::shared();
+    auto  chunk_size = std::max<std::size_t>( a_policy.chunk_size, 1 );
+    auto  chunks     = ( wrappers.size() + chunk_size - 1 ) / chunk_size;
+    auto  threads    = a_policy.max_threads ? a_policy.max_threads
+                                            : pool.size() + 1;
+
+    auto  run        = [&]( std::size_t a_chunk )
+    {
+        const auto first = a_chunk * chunk_size;
+        const auto count = std::min( chunk_size, wrappers.size() - first );
+
+        detail::visit_chunk<wrapper_type>(
+            std::span<wrapper_type *const>( wrappers ).subspan( first, count ),
+            a_function,
+            a_policy.try_passes
+        );
+    };
+
+    detail::run_parallel( pool, threads, chunks, run );
+}
+
+namespace detail {
+
+/**
+ * @brief The part of a container passed to the function of
+ * `zdm::with_lock_parallel`.
+ */
+template <class AContainedType>
+using partition_t
+    = std::ranges::subrange<std::ranges::iterator_t<const AContainedType>>;
+
+/**
+ * @brief The result of `zdm::with_lock_parallel`: nothing for functions
+ * returning `void`, otherwise one result per partition.
+ */
+template <class AResult>
+using partition_results_t = std::
+    conditional_t<std::is_void_v<AResult>, void, std::vector<AResult>>;
+
+} // namespace detail
+
+/**
+ * @brief Runs a function over partitions of a wrapped container in
+ * parallel, under a single shared lock.
+ *
+ * The container is split into `a_partitions` contiguous subranges of about
+ * the same size, which the caller and helper threads from the pool claim one
+ * at a time. The lock is held until every partition is done. The caller runs
+ * every partition no helper has started, so the call never waits for pool
+ * threads that are busy, even ones blocked on this wrapper.
+ *
+ * The function is shared between threads and must be safe to call
+ * concurrently on different partitions. If it throws, no further partitions
+ * are started and the first exception is rethrown once all threads are done.
+ *
+ * @param a_wrapper The wrapper to lock.
+ * @param a_function A callable taking a `detail::partition_t`, a subrange of
+ * the contained container.
+ * @param a_partitions The number of partitions, at most one per element.
+ * Zero means one per thread.
+ * @param a_policy The pool and the maximum number of threads. The chunk size
+ * and try passes are not used.
+ * @param a_site Where the lock is requested, for instrumented mutexes.
+ * @return The result of the function for every partition, in order, unless
+ * it returns `void`.
+ */
+template <class AContainedType, class AMutexType, class AFunction>
+    requires std::ranges::random_access_range<const AContainedType>
+          && std::ranges::sized_range<const AContainedType>
+          && std::invocable<AFunction &, detail::partition_t<AContainedType>>
+auto
+with_lock_parallel(
+    const basic_lock_wrapper<AContainedType, AMutexType> &a_wrapper,
+    AFunction                                          &&a_function,
+    std::size_t                                          a_partitions = 0,
+    parallel_policy                                      a_policy     = {},
+    const std::source_location                          &a_site
+    = std::source_location::current()
+)
+    -> detail::partition_results_t<std::invoke_result_t<
+        AFunction &,
+        detail::partition_t<AContainedType>>>
+{
+    using partition_type = detail::partition_t<AContainedType>;
+    using result_type    = std::invoke_result_t<AFunction &, partition_type>;
+    using results_type   = detail::partition_results_t<result_type>;
+
+    auto &pool    = a_policy.pool ? *a_policy.pool : thread_pool::shared();
+    auto  threads = a_policy.max_threads ? a_policy.max_threads
+                                         : pool.size() + 1;
+
+    return a_wrapper.with_lock(
+        [&]( const AContainedType& a_contained ) -> results_type
+        {
+            const auto size  = std::ranges::size( a_contained );
+            const auto count = std::min<std::size_t>(
+                a_partitions ? a_partitions : threads,
+                size
+            );
+
+            [[maybe_unused]] auto partial = std::conditional_t<
+                std::is_void_v<result_type>,
+                int,
+                std::vector<std::optional<result_type>>>{};
+
+            if constexpr( !std::is_void_v<result_type> )
+            {
+                partial.resize( count );
+            }
+
+            auto run = [&]( std::size_t a_partition )
+            {
+                using difference_type
+                    = std::ranges::range_difference_t<const AContainedType>;
+
+                const auto begin = std::ranges::begin( a_contained );
+                const auto first = a_partition * size / count;
+                const auto last  = ( a_partition + 1 ) * size / count;
+                const partition_type part(
+                    begin + static_cast<difference_type>( first ),
+                    begin + static_cast<difference_type>( last )
+                );
+
+                if constexpr( std::is_void_v<result_type> )
+                {
+                    a_function( part );
+                }
+                else
+                {
+                    partial[a_partition].emplace( a_function( part ) );
+                }
+            };
+
+            detail::run_parallel( pool, threads, count, run );
+
+            if constexpr( !std::is_void_v<result_type> )
+            {
+                std::vector<result_type> results;
+                results.reserve( count );
+
+                for( auto &result : partial )
+                {
+                    results.push_back( std::move( *result ) );
+                }
+
+                return results;
+            }
+        },
+        a_site
+    );
+}
+
+} // namespace zdm
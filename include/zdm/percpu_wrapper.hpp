@@ -0,0 +1,167 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <zdm/detail/current_cpu.hpp>
+#include <zdm/lock_wrapper.hpp>
+
+namespace zdm::detail {
+
+/**
+ * @brief The slot of one CPU, on a cache line of its own.
+ */
+template <class T>
+struct alignas( 64 ) percpu_slot
+{
+        zdm::lock_wrapper<T> value;
+};
+
+/**
+ * @brief A stand-in CPU id for threads on systems without `current_cpu`,
+ * assigned round robin.
+ */
+inline std::size_t
+fallback_cpu() noexcept
+{
+    static std::atomic<std::size_t> s_next{ 0 };
+    thread_local const std::size_t  t_cpu
+        = s_next.fetch_add( 1, std::memory_order_relaxed );
+    return t_cpu;
+}
+
+} // namespace zdm::detail
+
+namespace zdm {
+
+/**
+ * @brief One `T` per CPU, for counters and free lists that every thread
+ * updates and that are only read as a whole.
+ *
+ * `with_lock` runs a function on the slot of the CPU the calling thread runs
+ * on, found with `sched_getcpu`, and `fold` combines every slot. Unlike per
+ * thread storage, the number of slots does not grow with the number of
+ * threads.
+ *
+ * Each slot is locked while in use. Only the threads running on one CPU use
+ * its slot, one at a time unless preempted or migrated in the middle of an
+ * update, so the lock is practically never contended and its cache line
+ * stays on that CPU.
+ */
+template <class T>
+class percpu_wrapper
+{
+    public:
+        percpu_wrapper()
+            : m_slot_count( detail::cpu_count() )
+            , m_slots(
+                  std::make_unique<detail::percpu_slot<T>[]>( m_slot_count )
+              )
+        {
+        }
+
+        /**
+         * @brief Starts every slot as a copy of `a_initial`.
+         */
+        explicit percpu_wrapper(
+            const T &a_initial
+        )
+            : percpu_wrapper()
+        {
+            for( std::size_t i = 0; i < m_slot_count; ++i )
+            {
+                *m_slots[i].value = a_initial;
+            }
+        }
+
+        percpu_wrapper( const percpu_wrapper & )            = delete;
+        percpu_wrapper &operator=( const percpu_wrapper & ) = delete;
+
+        /**
+         * @brief Executes a function on the slot of the current CPU.
+         *
+         * @return The result of the function.
+         */
+        inline auto
+        with_lock(
+            concepts::unary_reference_function<T> auto &&a_function
+        ) -> decltype( a_function( std::declval<T &>() ) )
+        {
+            return local_slot().value.with_lock( a_function );
+        }
+
+        /**
+         * @brief Combines every slot, locking one at a time.
+         *
+         * @param a_initial The starting value.
+         * @param a_operation Called as `a_operation( accumulated, slot )`
+         * for every slot, returning the new accumulated value.
+         */
+        template <class AResult, class AOperation>
+        AResult
+        fold(
+            AResult      a_initial,
+            AOperation &&a_operation
+        ) const
+        {
+            for( std::size_t i = 0; i < m_slot_count; ++i )
+            {
+                m_slots[i].value.with_lock(
+                    [&]( const T& a_slot )
+                    {
+                        a_initial
+                            = a_operation( std::move( a_initial ), a_slot );
+                    }
+                );
+            }
+
+            return a_initial;
+        }
+
+        /**
+         * @brief The number of slots, one per configured CPU.
+         */
+        std::size_t
+        slot_count() const noexcept
+        {
+            return m_slot_count;
+        }
+
+    private:
+        detail::percpu_slot<T> &
+        local_slot() noexcept
+        {
+            const auto cpu   = detail::current_cpu();
+            const auto index = cpu >= 0 ? static_cast<std::size_t>( cpu )
+                                        : detail::fallback_cpu();
+            return m_slots[index % m_slot_count];
+        }
+
+        const std::size_t                         m_slot_count;
+        std::unique_ptr<detail::percpu_slot<T>[]> m_slots;
+};
+
+} // namespace zdm
@@ -0,0 +1,387 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <source_location>
+#include <utility>
+#include <vector>
+#include <zdm/lock_wrapper.hpp>
+#include <zdm/shared_lock_wrapper.hpp>
+#include <zdm/thread_pool.hpp>
+
+namespace zdm {
+
+/**
+ * @brief A lock wrapper whose mutations can be queued to a strand.
+ *
+ * `post` and `dispatch` enqueue functions taking a reference to the contained
+ * object. Queued functions are run one at a time, in submission order, on a
+ * `zdm::thread_pool`. A strand only occupies a pool thread while it has work,
+ * so any number of wrappers can share one pool.
+ *
+ * Queued functions are executed in batches while holding the wrapper's
+ * unique lock, so `with_lock` can still be used alongside the strand. Pool
+ * threads never block on the lock: while a `with_lock` caller holds it, the
+ * strand is parked and that caller reschedules it when releasing the lock.
+ *
+ * The destructor blocks until every queued function has run.
+ */
+template <class AContainedType, zdm::concepts::lockable AMutexType>
+class basic_strand_wrapper
+{
+    public:
+        using task_type = std::function<void( AContainedType & )>;
+
+        explicit basic_strand_wrapper(
+            thread_pool &a_pool = thread_pool::shared()
+        )
+            : m_pool( a_pool )
+        {
+        }
+
+        basic_strand_wrapper(
+            thread_pool     &a_pool,
+            AContainedType &&a_contained
+        )
+            : m_pool( a_pool )
+            , m_wrapper( std::forward<AContainedType>( a_contained ) )
+        {
+        }
+
+        explicit basic_strand_wrapper(
+            AContainedType &&a_contained
+        )
+            : basic_strand_wrapper(
+                  thread_pool::shared(),
+                  std::forward<AContainedType>( a_contained )
+              )
+        {
+        }
+
+        basic_strand_wrapper( const basic_strand_wrapper & ) = delete;
+        basic_strand_wrapper &
+        operator=( const basic_strand_wrapper & ) = delete;
+
+        ~basic_strand_wrapper()
+        {
+            std::unique_lock lock( m_queue_mutex );
+            m_idle.wait(
+                lock,
+                [this]()
+                {
+                    return !m_scheduled;
+                }
+            );
+        }
+
+        /**
+         * @copydoc basic_lock_wrapper::with_lock
+         */
+        inline auto
+        with_lock(
+            concepts::unary_reference_function<AContainedType> auto
+                                       &&a_function,
+            const std::source_location &a_site
+            = std::source_location::current()
+        ) -> decltype( a_function( std::declval<AContainedType &>() ) )
+        {
+            const holder_scope holder( *this );
+            return m_wrapper.with_lock(
+                std::forward<decltype( a_function )>( a_function ),
+                a_site
+            );
+        }
+
+        /**
+         * @copydoc basic_lock_wrapper::with_lock
+         */
+        inline auto
+        with_lock(
+            concepts::unary_const_reference_function<AContainedType> auto
+                                       &&a_function,
+            const std::source_location &a_site
+            = std::source_location::current()
+        ) const
+            -> decltype( a_function( std::declval<const AContainedType &>() ) )
+        {
+            const holder_scope holder( *this );
+            return m_wrapper.with_lock(
+                std::forward<decltype( a_function )>( a_function ),
+                a_site
+            );
+        }
+
+        /**
+         * @brief Queues a function to run on the strand.
+         *
+         * The function never runs inside this call, even when called from a
+         * function already running on the strand.
+         *
+         * @param a_function A callable that takes a reference to the contained
+         * object. Its return value is discarded.
+         */
+        void
+        post(
+            concepts::unary_reference_function<AContainedType> auto &&a_function
+        )
+        {
+            bool start = false;
+
+            {
+                std::scoped_lock lock( m_queue_mutex );
+                m_queue.emplace_back(
+                    std::forward<decltype( a_function )>( a_function )
+                );
+                start       = !m_scheduled;
+                m_scheduled = true;
+            }
+
+            if( start )
+            {
+                schedule();
+            }
+        }
+
+        /**
+         * @brief Runs a function on the strand.
+         *
+         * If the calling thread is currently running a function of this
+         * strand, the function is invoked immediately. Otherwise it behaves
+         * like `post`.
+         *
+         * @param a_function A callable that takes a reference to the contained
+         * object. Its return value is discarded.
+         */
+        void
+        dispatch(
+            concepts::unary_reference_function<AContainedType> auto &&a_function
+        )
+        {
+            if( s_running == this )
+            {
+                a_function( *m_running_value );
+                return;
+            }
+
+            post( std::forward<decltype( a_function )>( a_function ) );
+        }
+
+        /**
+         * @brief Whether the calling thread is running a function of this
+         * strand.
+         */
+        bool
+        running_in_this_thread() const noexcept
+        {
+            return s_running == this;
+        }
+
+    private:
+        /**
+         * @brief Counts a caller of `with_lock` while it may hold the lock.
+         * The last one to release it reschedules the strand if it was parked
+         * meanwhile, or runs it on its own thread if the pool can not take
+         * it.
+         */
+        class holder_scope
+        {
+            public:
+                explicit holder_scope(
+                    const basic_strand_wrapper &a_strand
+                )
+                    : m_strand( a_strand )
+                {
+                    std::scoped_lock lock( m_strand.m_queue_mutex );
+                    ++m_strand.m_holders;
+                }
+
+                holder_scope( const holder_scope & )            = delete;
+                holder_scope &operator=( const holder_scope & ) = delete;
+
+                ~holder_scope()
+                {
+                    bool resume = false;
+
+                    {
+                        std::scoped_lock lock( m_strand.m_queue_mutex );
+
+                        if( --m_strand.m_holders == 0 )
+                        {
+                            resume            = m_strand.m_parked;
+                            m_strand.m_parked = false;
+                        }
+                    }
+
+                    if( !resume )
+                    {
+                        return;
+                    }
+
+                    // Only a strand with queued functions parks, and
+                    // queueing takes a non-const strand.
+                    auto &strand
+                        = const_cast<basic_strand_wrapper &>( m_strand );
+
+                    try
+                    {
+                        strand.schedule();
+                    }
+                    catch( ... )
+                    {
+                        // The lock is released, so the batch can run here.
+                        strand.run();
+                    }
+                }
+
+            private:
+                const basic_strand_wrapper &m_strand;
+        };
+
+        /**
+         * @brief Marks the calling thread as running the strand, until
+         * destroyed, also when a task throws.
+         */
+        class running_scope
+        {
+            public:
+                running_scope(
+                    basic_strand_wrapper &a_strand,
+                    AContainedType       &a_contained
+                ) noexcept
+                    : m_strand( a_strand )
+                    , m_previous( s_running )
+                {
+                    s_running                 = &m_strand;
+                    m_strand.m_running_value = &a_contained;
+                }
+
+                running_scope( const running_scope & )            = delete;
+                running_scope &operator=( const running_scope & ) = delete;
+
+                ~running_scope()
+                {
+                    m_strand.m_running_value = nullptr;
+                    s_running                = m_previous;
+                }
+
+            private:
+                basic_strand_wrapper       &m_strand;
+                const basic_strand_wrapper *m_previous;
+        };
+
+        void
+        schedule()
+        {
+            m_pool.submit(
+                [this]()
+                {
+                    run();
+                }
+            );
+        }
+
+        /**
+         * @brief Runs one batch of queued functions and reschedules itself on
+         * the pool if more were queued meanwhile, so that a busy strand can
+         * not starve the others sharing the pool.
+         *
+         * The lock is only tried, so a pool thread never blocks on it. When a
+         * caller of `with_lock` holds it, the strand parks until that caller
+         * releases it and reschedules the strand.
+         */
+        void
+        run()
+        {
+            const bool ran = m_wrapper.try_with_lock(
+                [this]( AContainedType &a_contained )
+                {
+                    std::vector<task_type> batch;
+
+                    {
+                        std::scoped_lock lock( m_queue_mutex );
+                        batch.swap( m_queue );
+                    }
+
+                    const running_scope running( *this, a_contained );
+
+                    for( auto &task : batch )
+                    {
+                        task( a_contained );
+                    }
+                }
+            );
+
+            bool reschedule = false;
+
+            {
+                std::scoped_lock lock( m_queue_mutex );
+
+                if( !ran && m_holders > 0 )
+                {
+                    // The last holder to release the lock reschedules.
+                    m_parked = true;
+                    return;
+                }
+
+                reschedule  = !m_queue.empty();
+                m_scheduled = reschedule;
+
+                if( !reschedule )
+                {
+                    m_idle.notify_all();
+                }
+            }
+
+            if( reschedule )
+            {
+                schedule();
+            }
+        }
+
+        static inline thread_local const basic_strand_wrapper *s_running
+            = nullptr;
+
+        thread_pool                                    &m_pool;
+        basic_lock_wrapper<AContainedType, AMutexType> m_wrapper;
+        mutable std::mutex                             m_queue_mutex;
+        std::condition_variable                        m_idle;
+        std::vector<task_type>                         m_queue;
+        bool                                           m_scheduled = false;
+        mutable bool                                   m_parked    = false;
+        mutable std::size_t                            m_holders   = 0;
+        AContainedType                                *m_running_value
+            = nullptr;
+};
+
+template <class T>
+using strand_wrapper = basic_strand_wrapper<T, std::mutex>;
+
+template <class T>
+using shared_strand_wrapper = basic_strand_wrapper<T, std::shared_mutex>;
+
+} // namespace zdm
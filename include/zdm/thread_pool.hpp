@@ -0,0 +1,172 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace zdm {
+
+/**
+ * @brief A fixed size pool of worker threads executing submitted tasks in
+ * FIFO order.
+ *
+ * The pool is the shared executor for the asynchronous parts of the library,
+ * such as `zdm::basic_strand_wrapper`. Tasks must not throw; an exception
+ * escaping a task terminates the program, just like for `std::thread`.
+ *
+ * The destructor finishes every task that was submitted before it was called
+ * and then joins the workers.
+ */
+class thread_pool
+{
+    public:
+        using task_type = std::function<void()>;
+
+        explicit thread_pool(
+            std::size_t a_thread_count = default_thread_count()
+        )
+        {
+            const auto thread_count
+                = std::max<std::size_t>( a_thread_count, 1 );
+
+            m_threads.reserve( thread_count );
+
+            for( std::size_t i = 0; i < thread_count; ++i )
+            {
+                m_threads.emplace_back(
+                    [this]()
+                    {
+                        worker_loop();
+                    }
+                );
+            }
+        }
+
+        thread_pool( const thread_pool & )            = delete;
+        thread_pool &operator=( const thread_pool & ) = delete;
+
+        ~thread_pool()
+        {
+            {
+                std::scoped_lock lock( m_mutex );
+                m_stopping = true;
+            }
+
+            m_condition.notify_all();
+
+            for( auto &thread : m_threads )
+            {
+                thread.join();
+            }
+        }
+
+        /**
+         * @brief Enqueues a task to be executed by one of the workers.
+         *
+         * @param a_task The task to execute.
+         */
+        void
+        submit(
+            task_type a_task
+        )
+        {
+            {
+                std::scoped_lock lock( m_mutex );
+                m_tasks.push_back( std::move( a_task ) );
+            }
+
+            m_condition.notify_one();
+        }
+
+        /**
+         * @brief The number of worker threads.
+         */
+        std::size_t
+        size() const noexcept
+        {
+            return m_threads.size();
+        }
+
+        /**
+         * @brief The process wide pool used when no pool is given explicitly.
+         */
+        static thread_pool &
+        shared()
+        {
+            static thread_pool s_pool;
+            return s_pool;
+        }
+
+        static std::size_t
+        default_thread_count() noexcept
+        {
+            return std::max( std::thread::hardware_concurrency(), 1U );
+        }
+
+    private:
+        void
+        worker_loop()
+        {
+            for( ;; )
+            {
+                task_type task;
+
+                {
+                    std::unique_lock lock( m_mutex );
+                    m_condition.wait(
+                        lock,
+                        [this]()
+                        {
+                            return m_stopping || !m_tasks.empty();
+                        }
+                    );
+
+                    if( m_tasks.empty() )
+                    {
+                        return;
+                    }
+
+                    task = std::move( m_tasks.front() );
+                    m_tasks.pop_front();
+                }
+
+                task();
+            }
+        }
+
+        std::mutex               m_mutex;
+        std::condition_variable  m_condition;
+        std::deque<task_type>    m_tasks;
+        bool                     m_stopping = false;
+        std::vector<std::thread> m_threads;
+};
+
+} // namespace zdm
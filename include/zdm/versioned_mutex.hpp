@@ -0,0 +1,203 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <zdm/lock_wrapper.hpp>
+
+#if defined( __linux__ )
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace zdm::detail {
+
+/**
+ * @brief Bit 0 of a version word, set while a `zdm::wait_any` caller sleeps
+ * on that word.
+ *
+ * An unlock only issues wake ups when it finds the bit set, so waiting on one
+ * `zdm::versioned_mutex` costs the unlocks of every other one nothing.
+ */
+inline constexpr std::uint32_t version_waiting_bit = 1;
+
+/**
+ * @brief The amount an exclusive unlock adds to the version word. The version
+ * itself lives in the bits above `version_waiting_bit`.
+ */
+inline constexpr std::uint32_t version_step = 2;
+
+/**
+ * @brief Incremented on every version change that had waiters. Used by the
+ * portable `wait_any` fallback, which can not wait on several words.
+ */
+inline std::atomic<std::uint32_t> version_epoch{ 0 };
+
+inline void
+notify_version_change(
+    std::atomic<std::uint32_t> &a_version
+) noexcept
+{
+#if defined( __linux__ )
+    ::syscall(
+        SYS_futex,
+        &a_version,
+        FUTEX_WAKE_PRIVATE,
+        INT_MAX,
+        nullptr,
+        nullptr,
+        0
+    );
+#else
+    static_cast<void>( a_version );
+#endif
+    version_epoch.fetch_add( 1 );
+    version_epoch.notify_all();
+}
+
+} // namespace zdm::detail
+
+namespace zdm {
+
+/**
+ * @brief A mutex adapter that counts modifications.
+ *
+ * Every exclusive unlock increments a 31 bit version, kept in a 32 bit word
+ * that `zdm::wait_any` can block on. Shared unlocks leave the version
+ * unchanged, so with a shared capable `AMutex` only the mutable `with_lock`
+ * overload changes the version. With an exclusive only `AMutex` every
+ * `with_lock` does.
+ */
+template <zdm::concepts::lockable AMutex = std::mutex>
+class versioned_mutex
+{
+    public:
+        void
+        lock()
+        {
+            m_mutex.lock();
+        }
+
+        bool
+        try_lock()
+            requires requires( AMutex &a_mutex ) { a_mutex.try_lock(); }
+        {
+            return m_mutex.try_lock();
+        }
+
+        /**
+         * @brief Counts the change and wakes its waiters before releasing
+         * the lock, as the mutex may be destroyed as soon as it is released.
+         * Waiters read the version without the lock, so they see the change
+         * either way.
+         */
+        void
+        unlock()
+        {
+            const auto previous = m_version.fetch_add( detail::version_step );
+
+            if( ( previous & detail::version_waiting_bit ) != 0 )
+            {
+                m_version.fetch_and( ~detail::version_waiting_bit );
+                detail::notify_version_change( m_version );
+            }
+
+            m_mutex.unlock();
+        }
+
+        void
+        lock_shared()
+            requires concepts::shared_lockable<AMutex>
+        {
+            m_mutex.lock_shared();
+        }
+
+        bool
+        try_lock_shared()
+            requires concepts::shared_lockable<AMutex>
+        {
+            return m_mutex.try_lock_shared();
+        }
+
+        void
+        unlock_shared()
+            requires concepts::shared_lockable<AMutex>
+        {
+            m_mutex.unlock_shared();
+        }
+
+        /**
+         * @brief The number of exclusive unlocks so far, wrapping around at
+         * 2^31.
+         */
+        std::uint32_t
+        version() const noexcept
+        {
+            return m_version.load( std::memory_order_acquire ) >> 1;
+        }
+
+        /**
+         * @brief The version word itself, for `zdm::wait_any`. It holds the
+         * version shifted left by one, and `detail::version_waiting_bit`.
+         */
+        std::atomic<std::uint32_t> &
+        version_word() const noexcept
+        {
+            return m_version;
+        }
+
+    private:
+        static_assert( std::atomic<std::uint32_t>::is_always_lock_free );
+        static_assert(
+            sizeof( std::atomic<std::uint32_t> ) == sizeof( std::uint32_t )
+        );
+
+        AMutex                             m_mutex;
+        mutable std::atomic<std::uint32_t> m_version{ 0 };
+};
+
+template <class AMutex>
+struct mutex_traits<versioned_mutex<AMutex>>
+{
+        using mutex_type  = versioned_mutex<AMutex>;
+        using unique_lock = std::unique_lock<mutex_type>;
+        using shared_lock = std::conditional_t<
+            concepts::shared_lockable<AMutex>,
+            std::shared_lock<mutex_type>,
+            std::unique_lock<mutex_type>>;
+};
+
+template <class T>
+using versioned_lock_wrapper = basic_lock_wrapper<T, versioned_mutex<>>;
+
+template <class T>
+using versioned_shared_lock_wrapper
+    = basic_lock_wrapper<T, versioned_mutex<std::shared_mutex>>;
+
+} // namespace zdm
@@ -0,0 +1,249 @@
+#pragma once
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <zdm/versioned_mutex.hpp>
+
+#if defined( __linux__ )
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace zdm::concepts {
+
+/**
+ * @brief Concept for a wrapper whose mutex exposes a version word, such as
+ * `zdm::versioned_lock_wrapper`.
+ */
+template <class AWrapper>
+concept versioned_wrapper = requires( const AWrapper &a_wrapper ) {
+    {
+        a_wrapper.mutex().version_word()
+    } -> std::same_as<std::atomic<std::uint32_t> &>;
+};
+
+} // namespace zdm::concepts
+
+namespace zdm::detail {
+
+inline constexpr std::size_t no_change = static_cast<std::size_t>( -1 );
+
+/**
+ * @brief Sets `version_waiting_bit` on every word whose version is still the
+ * one seen, so the next unlock of that word wakes the caller.
+ *
+ * @return The index of the first word whose version changed, or `no_change`.
+ */
+inline std::size_t
+announce_version_waiter(
+    std::span<std::atomic<std::uint32_t> *const> a_words,
+    std::span<const std::uint32_t>               a_seen
+) noexcept
+{
+    for( std::size_t i = 0; i < a_words.size(); ++i )
+    {
+        auto word = a_words[i]->load();
+
+        for( ;; )
+        {
+            if( ( word >> 1 ) != a_seen[i] )
+            {
+                return i;
+            }
+
+            if( ( word & version_waiting_bit ) != 0
+                || a_words[i]->compare_exchange_weak(
+                    word,
+                    word | version_waiting_bit
+                ) )
+            {
+                break;
+            }
+        }
+    }
+
+    return no_change;
+}
+
+/**
+ * @brief Blocks on several version words at once with `futex_waitv`.
+ *
+ * Returns without sleeping if a word no longer holds the version seen with
+ * `version_waiting_bit` set, since the unlock that cleared the bit may
+ * already have issued its wake up.
+ *
+ * @return `false` if `futex_waitv` is not available or fails for any reason
+ * other than a changed word or a signal, in which case the caller falls back
+ * to waiting on `version_epoch` from then on.
+ */
+inline bool
+futex_wait_versions(
+    [[maybe_unused]] std::span<std::atomic<std::uint32_t> *const> a_words,
+    [[maybe_unused]] std::span<const std::uint32_t>               a_seen
+) noexcept
+{
+#if defined( __linux__ ) && defined( SYS_futex_waitv )
+    static std::atomic<bool> s_unsupported{ false };
+
+    if( s_unsupported.load( std::memory_order_relaxed )
+        || a_words.size() > FUTEX_WAITV_MAX )
+    {
+        return false;
+    }
+
+    std::array<futex_waitv, FUTEX_WAITV_MAX> waiters{};
+
+    for( std::size_t i = 0; i < a_words.size(); ++i )
+    {
+        const auto word = a_words[i]->load();
+
+        if( word != ( ( a_seen[i] << 1 ) | version_waiting_bit ) )
+        {
+            return true;
+        }
+
+        waiters[i].val   = word;
+        waiters[i].uaddr = reinterpret_cast<std::uintptr_t>( a_words[i] );
+        waiters[i].flags = FUTEX_32 | FUTEX_PRIVATE_FLAG;
+    }
+
+    if( ::syscall(
+            SYS_futex_waitv,
+            waiters.data(),
+            static_cast<unsigned int>( a_words.size() ),
+            0U,
+            nullptr,
+            0
+        )
+            == -1
+        && errno != EAGAIN && errno != EINTR )
+    {
+        s_unsupported.store( true, std::memory_order_relaxed );
+        return false;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+inline std::size_t
+wait_any_version(
+    std::span<std::atomic<std::uint32_t> *const> a_words,
+    std::span<std::uint32_t>                     a_seen
+)
+{
+    std::size_t changed = no_change;
+
+    for( ;; )
+    {
+        const auto epoch = version_epoch.load();
+        changed          = announce_version_waiter( a_words, a_seen );
+
+        if( changed != no_change )
+        {
+            break;
+        }
+
+        if( !futex_wait_versions( a_words, a_seen ) )
+        {
+            version_epoch.wait( epoch );
+        }
+    }
+
+    for( std::size_t i = 0; i < a_words.size(); ++i )
+    {
+        a_seen[i] = a_words[i]->load() >> 1;
+    }
+
+    return changed;
+}
+
+} // namespace zdm::detail
+
+namespace zdm {
+
+/**
+ * @brief The current versions of several versioned wrappers.
+ */
+template <concepts::versioned_wrapper... AWrappers>
+std::array<std::uint32_t, sizeof...( AWrappers )>
+versions(
+    const AWrappers &...a_wrappers
+) noexcept
+{
+    return { a_wrappers.mutex().version()... };
+}
+
+/**
+ * @brief Blocks until the version of any of the wrappers differs from the
+ * version last seen.
+ *
+ * Uses Linux `futex_waitv` to sleep on all version words at once, and a
+ * process wide wake up counter where that is not available. Either way only
+ * unlocks of the wrappers waited on issue wake ups.
+ *
+ * @param a_seen The versions last seen, as returned by `zdm::versions`.
+ * Updated to the current versions on return, so it can be passed to the next
+ * call without missing changes in between.
+ * @return The index of the first wrapper whose version changed.
+ */
+template <concepts::versioned_wrapper... AWrappers>
+std::size_t
+wait_any(
+    std::array<std::uint32_t, sizeof...( AWrappers )> &a_seen,
+    const AWrappers &...a_wrappers
+)
+{
+    const std::array<std::atomic<std::uint32_t> *, sizeof...( AWrappers )>
+        words{ &a_wrappers.mutex().version_word()... };
+
+    return detail::wait_any_version( words, a_seen );
+}
+
+/**
+ * @brief Blocks until the version of any of the wrappers changes from its
+ * version at the time of the call.
+ *
+ * @return The index of the first wrapper whose version changed.
+ */
+template <concepts::versioned_wrapper... AWrappers>
+std::size_t
+wait_any(
+    const AWrappers &...a_wrappers
+)
+{
+    auto seen = versions( a_wrappers... );
+    return wait_any( seen, a_wrappers... );
+}
+
+} // namespace zdm
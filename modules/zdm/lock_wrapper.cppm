@@ -0,0 +1,56 @@
+/*
+MIT License
+
+Copyright (c) 2025 Zachary D Meyer
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+module;
+
+#include <zdm/lock_wrapper.hpp>
+#include <zdm/shared_lock_wrapper.hpp>
+
+/**
+ * @brief The `zdm.lock_wrapper` module: the wrappers of `zdm/lock_wrapper.hpp`
+ * and `zdm/shared_lock_wrapper.hpp`.
+ *
+ * `mutex_traits` is exported, so custom mutexes can still be adapted by
+ * specializing it after `import zdm.lock_wrapper;`.
+ */
+export module zdm.lock_wrapper;
+
+export namespace zdm::concepts {
+
+using zdm::concepts::lockable;
+using zdm::concepts::shared_lockable;
+using zdm::concepts::unary_const_reference_function;
+using zdm::concepts::unary_reference_function;
+
+} // namespace zdm::concepts
+
+export namespace zdm {
+
+using zdm::basic_lock_wrapper;
+using zdm::lock_wrapper;
+using zdm::locked_range;
+using zdm::mutex_traits;
+using zdm::recursive_lock_wrapper;
+using zdm::shared_lock_wrapper;
+
+} // namespace zdm
@@ -0,0 +1,95 @@
+# Compares the disassembly of the zdm_codegen_wrapped_* functions in OBJECT
+# with their zdm_codegen_reference_* counterparts. Fails when a wrapped
+# function has more instructions or calls than its reference.
+#
+# Usage: cmake -DOBJDUMP=<objdump> -DOBJECT=<object> -P compare_codegen.cmake
+
+cmake_minimum_required(VERSION 3.27)
+
+if(NOT OBJDUMP OR NOT OBJECT)
+  message(FATAL_ERROR "OBJDUMP and OBJECT must be set")
+endif()
+
+execute_process(
+  COMMAND "${OBJDUMP}" -d --no-show-raw-insn "${OBJECT}"
+  OUTPUT_VARIABLE listing
+  RESULT_VARIABLE result
+)
+
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "${OBJDUMP} failed on ${OBJECT}")
+endif()
+
+string(REPLACE ";" "," listing "${listing}")
+string(REPLACE "\n" ";" lines "${listing}")
+
+set(current "")
+set(functions "")
+
+foreach(line IN LISTS lines)
+  if(line MATCHES "^[0-9a-f]+ <(.+)>:$")
+    set(name "${CMAKE_MATCH_1}")
+
+    # Cold parts such as foo.cold are not on the hot path.
+    if(name MATCHES "^zdm_codegen_(wrapped|reference)_[A-Za-z0-9_]+$")
+      set(current "${name}")
+      set(${current}_instructions 0)
+      set(${current}_calls 0)
+      list(APPEND functions "${current}")
+    else()
+      set(current "")
+    endif()
+  elseif(current AND line MATCHES "^ +[0-9a-f]+:\t(.*)$")
+    set(instruction "${CMAKE_MATCH_1}")
+
+    # Padding between functions.
+    if(instruction MATCHES "^(nop|xchg +%ax,%ax|data16|cs nop|int3)")
+      continue()
+    endif()
+
+    math(EXPR ${current}_instructions "${${current}_instructions} + 1")
+
+    if(instruction MATCHES "^(call|bl|jal)")
+      math(EXPR ${current}_calls "${${current}_calls} + 1")
+    endif()
+  endif()
+endforeach()
+
+set(failed FALSE)
+set(compared 0)
+
+foreach(function IN LISTS functions)
+  if(NOT function MATCHES "^zdm_codegen_wrapped_(.+)$")
+    continue()
+  endif()
+
+  set(reference "zdm_codegen_reference_${CMAKE_MATCH_1}")
+
+  if(NOT reference IN_LIST functions)
+    message(SEND_ERROR "${function} has no ${reference}")
+    set(failed TRUE)
+    continue()
+  endif()
+
+  math(EXPR compared "${compared} + 1")
+  message(STATUS
+    "${CMAKE_MATCH_1}: "
+    "${${function}_instructions} instructions, ${${function}_calls} calls "
+    "(reference: ${${reference}_instructions} instructions, "
+    "${${reference}_calls} calls)"
+  )
+
+  if(${function}_instructions GREATER ${reference}_instructions
+     OR ${function}_calls GREATER ${reference}_calls)
+    message(SEND_ERROR "${function} is larger than ${reference}")
+    set(failed TRUE)
+  endif()
+endforeach()
+
+if(compared EQUAL 0)
+  message(FATAL_ERROR "no zdm_codegen_wrapped_* functions in ${OBJECT}")
+endif()
+
+if(failed)
+  message(FATAL_ERROR "with_lock codegen regressed")
+endif()
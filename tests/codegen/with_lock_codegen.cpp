@@ -0,0 +1,130 @@
+/**
+ * @brief Representative `with_lock` usages next to hand-written equivalents.
+ *
+ * Each `zdm_codegen_wrapped_*` function must compile to no more instructions
+ * and calls than its `zdm_codegen_reference_*` counterpart, which
+ * `compare_codegen.cmake` checks on the disassembly. The reference types
+ * mirror the layout of the wrappers, so the only difference is the code
+ * between the caller and the lock.
+ */
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <zdm/lock_wrapper.hpp>
+#include <zdm/shared_lock_wrapper.hpp>
+
+namespace {
+
+template <class AMutex>
+struct reference_wrapper
+{
+        AMutex m_mutex;
+        int    m_value;
+};
+
+} // namespace
+
+extern "C" {
+
+void
+zdm_codegen_wrapped_increment(
+    zdm::lock_wrapper<int> &a_wrapper
+)
+{
+    a_wrapper.with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+}
+
+void
+zdm_codegen_reference_increment(
+    reference_wrapper<std::mutex> &a_wrapper
+)
+{
+    std::scoped_lock lock( a_wrapper.m_mutex );
+    ++a_wrapper.m_value;
+}
+
+int
+zdm_codegen_wrapped_exchange(
+    zdm::lock_wrapper<int> &a_wrapper,
+    int                     a_value
+)
+{
+    return a_wrapper.with_lock(
+        [a_value]( int& value )
+        {
+            const auto previous = value;
+            value               = a_value;
+            return previous;
+        }
+    );
+}
+
+int
+zdm_codegen_reference_exchange(
+    reference_wrapper<std::mutex> &a_wrapper,
+    int                            a_value
+)
+{
+    std::scoped_lock lock( a_wrapper.m_mutex );
+    const auto       previous = a_wrapper.m_value;
+    a_wrapper.m_value         = a_value;
+    return previous;
+}
+
+int
+zdm_codegen_wrapped_shared_read(
+    const zdm::shared_lock_wrapper<int> &a_wrapper
+)
+{
+    return a_wrapper.with_lock(
+        []( const int& value )
+        {
+            return value;
+        }
+    );
+}
+
+int
+zdm_codegen_reference_shared_read(
+    reference_wrapper<std::shared_mutex> &a_wrapper
+)
+{
+    std::shared_lock lock( a_wrapper.m_mutex );
+    return a_wrapper.m_value;
+}
+
+bool
+zdm_codegen_wrapped_try_increment(
+    zdm::lock_wrapper<int> &a_wrapper
+)
+{
+    return a_wrapper.try_with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+}
+
+bool
+zdm_codegen_reference_try_increment(
+    reference_wrapper<std::mutex> &a_wrapper
+)
+{
+    std::unique_lock lock( a_wrapper.m_mutex, std::try_to_lock );
+
+    if( !lock.owns_lock() )
+    {
+        return false;
+    }
+
+    ++a_wrapper.m_value;
+    return true;
+}
+
+} // extern "C"
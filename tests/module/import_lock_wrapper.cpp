@@ -0,0 +1,32 @@
+/**
+ * @brief Checks that the wrappers can be used through
+ * `import zdm.lock_wrapper;`.
+ */
+#include <mutex>
+#include <shared_mutex>
+
+import zdm.lock_wrapper;
+
+int
+main()
+{
+    zdm::lock_wrapper<int>        wrapper( 41 );
+    zdm::shared_lock_wrapper<int> shared( 1 );
+
+    wrapper.with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+
+    const auto &readable = shared;
+    const auto  value    = readable.with_lock(
+        []( const int& a_value )
+        {
+            return a_value;
+        }
+    );
+
+    return *wrapper == 42 && value == 1 ? 0 : 1;
+}
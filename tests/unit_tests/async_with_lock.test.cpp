@@ -0,0 +1,249 @@
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <functional>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <zdm/async_with_lock.hpp>
+
+namespace {
+
+struct loop_receiver
+{
+        zdm::run_loop      *m_loop;
+        std::optional<int> *m_value;
+        std::exception_ptr *m_error;
+
+        void
+        set_value(
+            int a_value
+        )
+        {
+            *m_value = a_value;
+            m_loop->finish();
+        }
+
+        void
+        set_error(
+            std::exception_ptr a_error
+        )
+        {
+            *m_error = std::move( a_error );
+            m_loop->finish();
+        }
+};
+
+/**
+ * @brief A receiver that refuses its value.
+ */
+struct throwing_receiver
+{
+        zdm::run_loop      *m_loop;
+        std::exception_ptr *m_error;
+
+        void
+        set_value(
+            int
+        )
+        {
+            throw std::runtime_error( "value refused" );
+        }
+
+        void
+        set_error(
+            std::exception_ptr a_error
+        )
+        {
+            *m_error = std::move( a_error );
+            m_loop->finish();
+        }
+};
+
+/**
+ * @brief Counts the tasks submitted to a run_loop.
+ */
+struct counting_executor
+{
+        zdm::run_loop    *m_loop;
+        std::atomic<int> *m_submits;
+
+        void
+        submit(
+            std::function<void()> a_task
+        )
+        {
+            ++*m_submits;
+            m_loop->submit( std::move( a_task ) );
+        }
+};
+
+} // namespace
+
+TEST_CASE(
+    "async_with_lock - completes with the function's result",
+    "[async_with_lock]"
+)
+{
+    zdm::thread_pool       pool( 2 );
+    zdm::lock_wrapper<int> wrapper( 42 );
+
+    auto                   result = zdm::sync_wait( zdm::async_with_lock(
+        pool,
+        wrapper,
+        []( int& value )
+        {
+            return ++value;
+        }
+    ) );
+
+    REQUIRE( result == 43 );
+
+    zdm::sync_wait( zdm::async_with_lock(
+        pool,
+        wrapper,
+        []( int& value )
+        {
+            value = 0;
+        }
+    ) );
+
+    REQUIRE( *wrapper == 0 );
+}
+
+TEST_CASE(
+    "async_with_lock - errors are forwarded to the receiver",
+    "[async_with_lock]"
+)
+{
+    zdm::thread_pool       pool( 1 );
+    zdm::lock_wrapper<int> wrapper( 42 );
+
+    REQUIRE_THROWS_AS(
+        zdm::sync_wait( zdm::async_with_lock(
+            pool,
+            wrapper,
+            []( const int& value ) -> int
+            {
+                throw std::runtime_error( std::to_string( value ) );
+            }
+        ) ),
+        std::runtime_error
+    );
+}
+
+TEST_CASE(
+    "async_with_lock - a throwing set_value completes with set_error",
+    "[async_with_lock]"
+)
+{
+    zdm::run_loop          loop;
+    zdm::lock_wrapper<int> wrapper( 1 );
+    std::exception_ptr     error;
+
+    auto operation = zdm::async_with_lock(
+                         loop,
+                         wrapper,
+                         []( const int& contained )
+                         {
+                             return contained;
+                         }
+    )
+                         .connect( throwing_receiver{ &loop, &error } );
+
+    operation.start();
+    loop.run();
+
+    REQUIRE_THROWS_AS( std::rethrow_exception( error ), std::runtime_error );
+}
+
+TEST_CASE(
+    "async_with_lock - retries on a run_loop while the lock is held",
+    "[async_with_lock]"
+)
+{
+    zdm::run_loop          loop;
+    zdm::lock_wrapper<int> wrapper( 1 );
+    std::optional<int>     value;
+    std::exception_ptr     error;
+
+    auto                   operation = zdm::async_with_lock(
+                         loop,
+                         wrapper,
+                         []( const int& contained )
+                         {
+                             return contained * 2;
+                         }
+    )
+                         .connect( loop_receiver{ &loop, &value, &error } );
+
+    std::thread            driver;
+
+    wrapper.with_lock(
+        [&]( int& contained )
+        {
+            operation.start();
+            driver = std::thread(
+                [&loop]()
+                {
+                    loop.run();
+                }
+            );
+            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+            contained = 21;
+        }
+    );
+
+    driver.join();
+
+    REQUIRE_FALSE( error );
+    REQUIRE( value == 42 );
+}
+
+TEST_CASE(
+    "async_with_lock - backs off while the lock is held",
+    "[async_with_lock]"
+)
+{
+    zdm::run_loop          loop;
+    std::atomic<int>       submits{ 0 };
+    counting_executor      executor{ &loop, &submits };
+    zdm::lock_wrapper<int> wrapper( 1 );
+    std::optional<int>     value;
+    std::exception_ptr     error;
+
+    auto operation = zdm::async_with_lock(
+                         executor,
+                         wrapper,
+                         []( int& contained ) -> int&
+                         {
+                             return contained;
+                         }
+    )
+                         .connect( loop_receiver{ &loop, &value, &error } );
+
+    std::thread driver;
+
+    wrapper.with_lock(
+        [&]( int& contained )
+        {
+            operation.start();
+            driver = std::thread(
+                [&loop]()
+                {
+                    loop.run();
+                }
+            );
+            std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+            contained = 7;
+        }
+    );
+
+    driver.join();
+
+    REQUIRE_FALSE( error );
+    REQUIRE( value == 7 );
+    // About one attempt per millisecond once backed off, not a busy loop.
+    REQUIRE( submits < 500 );
+}
@@ -0,0 +1,168 @@
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <zdm/checkpoint.hpp>
+
+namespace {
+
+std::string
+read_file(
+    const std::filesystem::path &a_path
+)
+{
+    std::ifstream stream( a_path, std::ios::binary );
+    return { std::istreambuf_iterator<char>( stream ), {} };
+}
+
+bool
+has_temporaries(
+    const std::filesystem::path &a_path
+)
+{
+    const auto prefix = a_path.filename().string() + ".tmp";
+
+    for( const auto &entry :
+         std::filesystem::directory_iterator( a_path.parent_path() ) )
+    {
+        if( entry.path().filename().string().starts_with( prefix ) )
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace
+
+TEST_CASE(
+    "checkpoint - serializes outside the lock",
+    "[checkpoint]"
+)
+{
+    const auto path
+        = std::filesystem::temp_directory_path() / "zdm_checkpoint_test.bin";
+
+    zdm::thread_pool              pool( 1 );
+    zdm::cow_wrapper<std::string> wrapper( std::string( "before" ) );
+    std::promise<void>            serializing;
+    std::promise<void>            resume;
+    auto                          resumed = resume.get_future().share();
+
+    auto written = zdm::checkpoint(
+        wrapper,
+        path,
+        [&serializing,
+         resumed]( std::ostream& a_stream, const std::string& a_value )
+        {
+            serializing.set_value();
+            resumed.wait();
+            a_stream << a_value;
+        },
+        pool
+    );
+
+    serializing.get_future().wait();
+
+    // The serializer is running, yet the wrapper can still be changed.
+    auto changed = std::async(
+        std::launch::async,
+        [&wrapper]()
+        {
+            wrapper.with_lock(
+                []( std::string& a_value )
+                {
+                    a_value = "after";
+                }
+            );
+        }
+    );
+
+    REQUIRE(
+        changed.wait_for( std::chrono::seconds( 10 ) )
+        == std::future_status::ready
+    );
+
+    resume.set_value();
+
+    REQUIRE( written.get() );
+    REQUIRE( read_file( path ) == "before" );
+    REQUIRE( !has_temporaries( path ) );
+
+    zdm::lock_wrapper<std::string> plain( std::string( "plain" ) );
+
+    auto copied = zdm::checkpoint(
+        plain,
+        path,
+        []( std::ostream& a_stream, const std::string& a_value )
+        {
+            a_stream << a_value;
+        },
+        pool
+    );
+
+    REQUIRE( copied.get() );
+    REQUIRE( read_file( path ) == "plain" );
+
+    auto failed = zdm::checkpoint(
+        plain,
+        path,
+        []( std::ostream&, const std::string& )
+        {
+            throw std::runtime_error( "serializer failed" );
+        },
+        pool
+    );
+
+    REQUIRE_THROWS_AS( failed.get(), std::runtime_error );
+    REQUIRE( read_file( path ) == "plain" );
+    REQUIRE( !has_temporaries( path ) );
+
+    std::filesystem::remove( path );
+}
+
+TEST_CASE(
+    "checkpoint - concurrent checkpoints of one path write whole files",
+    "[checkpoint]"
+)
+{
+    const auto path = std::filesystem::temp_directory_path()
+                    / "zdm_checkpoint_concurrent_test.bin";
+
+    zdm::thread_pool               pool( 4 );
+    zdm::cow_wrapper<std::string>  wrapper( std::string( 4096, 'x' ) );
+    std::vector<std::future<bool>> written;
+
+    for( int i = 0; i < 16; ++i )
+    {
+        written.push_back( zdm::checkpoint(
+            wrapper,
+            path,
+            []( std::ostream& a_stream, const std::string& a_value )
+            {
+                for( const auto character : a_value )
+                {
+                    a_stream.put( character );
+                }
+            },
+            pool
+        ) );
+    }
+
+    for( auto &future : written )
+    {
+        REQUIRE( future.get() );
+    }
+
+    REQUIRE( read_file( path ) == std::string( 4096, 'x' ) );
+    REQUIRE( !has_temporaries( path ) );
+
+    std::filesystem::remove( path );
+}
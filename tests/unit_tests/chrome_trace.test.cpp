@@ -0,0 +1,169 @@
+#include <catch2/catch_all.hpp>
+#include <sstream>
+#include <string>
+#include <zdm/chrome_trace.hpp>
+
+namespace {
+
+zdm::instrumentation::lock_trace
+sample_trace()
+{
+    using zdm::instrumentation::lock_mode;
+
+    zdm::instrumentation::lock_trace trace;
+    trace.wrappers = { { 1, "cache \"hot\"" }, { 2, "" } };
+    trace.events   = {
+        { 1'000, 0, 2'500, 0, 1, lock_mode::exclusive, false },
+        { 1'500, 2'000, 750, 3, 1, lock_mode::exclusive, true },
+        { 9'000, 0, 1'234'567, 3, 2, lock_mode::shared, false },
+    };
+    return trace;
+}
+
+} // namespace
+
+TEST_CASE(
+    "write_chrome_trace - emits thread and wrapper tracks",
+    "[chrome_trace]"
+)
+{
+    std::ostringstream stream;
+    zdm::instrumentation::write_chrome_trace( stream, sample_trace() );
+    const auto json = stream.str();
+
+    REQUIRE( json.starts_with( R"({"displayTimeUnit":"ns","traceEvents":[)" ) );
+    REQUIRE( json.ends_with( "\n]}\n" ) );
+    REQUIRE_THAT(
+        json,
+        Catch::Matchers::ContainsSubstring(
+            R"("tid":3,"name":"thread_name","args":{"name":"thread 3"})"
+        )
+    );
+    REQUIRE_THAT(
+        json,
+        Catch::Matchers::ContainsSubstring(
+            R"("pid":2,"tid":1,"name":"thread_name",)"
+            R"("args":{"name":"cache \"hot\""})"
+        )
+    );
+    REQUIRE_THAT(
+        json,
+        Catch::Matchers::ContainsSubstring(
+            R"("args":{"name":"wrapper 2"})"
+        )
+    );
+}
+
+TEST_CASE(
+    "write_chrome_trace - writes wait and hold slices in microseconds",
+    "[chrome_trace]"
+)
+{
+    std::ostringstream stream;
+    zdm::instrumentation::write_chrome_trace( stream, sample_trace() );
+    const auto json = stream.str();
+
+    REQUIRE_THAT(
+        json,
+        Catch::Matchers::ContainsSubstring(
+            R"("cat":"lock.wait","name":"wait cache \"hot\"",)"
+            R"("ts":0.500,"dur":2.000,)"
+        )
+    );
+    REQUIRE_THAT(
+        json,
+        Catch::Matchers::ContainsSubstring(
+            R"("cat":"lock.hold","name":"hold cache \"hot\"",)"
+            R"("ts":2.500,"dur":0.750,)"
+        )
+    );
+    REQUIRE_THAT(
+        json,
+        Catch::Matchers::ContainsSubstring(
+            R"("pid":2,"tid":1,"cat":"lock.hold","name":"thread 3",)"
+            R"("ts":2.500,"dur":0.750,"args":{"wrapper":1,"thread":3,)"
+            R"("mode":"exclusive","contended":true})"
+        )
+    );
+
+    // Uncontended acquisitions have no wait slice.
+    REQUIRE_THAT(
+        json,
+        !Catch::Matchers::ContainsSubstring( R"("name":"wait wrapper 2")" )
+    );
+}
+
+TEST_CASE(
+    "write_chrome_trace - writes an empty trace",
+    "[chrome_trace]"
+)
+{
+    std::ostringstream stream;
+    zdm::instrumentation::write_chrome_trace(
+        stream,
+        zdm::instrumentation::lock_trace {}
+    );
+
+    REQUIRE_THAT(
+        stream.str(),
+        !Catch::Matchers::ContainsSubstring( R"("ph":"X")" )
+    );
+}
+
+TEST_CASE(
+    "write_chrome_trace - writes shared holds as async slices per holder",
+    "[chrome_trace]"
+)
+{
+    using zdm::instrumentation::lock_mode;
+
+    zdm::instrumentation::lock_trace trace;
+    trace.events = {
+        { 9'000, 0, 1'234'567, 3, 2, lock_mode::shared, false },
+        { 5'000, 0, 100, 1, 2, lock_mode::shared, false },
+        { 2'000, 500, 4'000, 0, 2, lock_mode::shared, true },
+    };
+
+    std::ostringstream stream;
+    zdm::instrumentation::write_chrome_trace( stream, trace );
+    const auto json = stream.str();
+
+    REQUIRE_THAT(
+        json,
+        Catch::Matchers::ContainsSubstring(
+            R"({"ph":"b","pid":2,"tid":2,"cat":"lock.hold","name":"thread 0",)"
+            R"("id":"2:0","ts":0.500,"args":{"wrapper":2,"thread":0,)"
+            R"("mode":"shared","contended":true}})"
+        )
+    );
+    REQUIRE_THAT(
+        json,
+        Catch::Matchers::ContainsSubstring(
+            R"({"ph":"e","pid":2,"tid":2,"cat":"lock.hold","name":"thread 0",)"
+            R"("id":"2:0","ts":4.500})"
+        )
+    );
+    REQUIRE_THAT(
+        json,
+        Catch::Matchers::ContainsSubstring(
+            R"({"ph":"b","pid":2,"tid":2,"cat":"lock.hold","name":"thread 1",)"
+            R"("id":"2:1","ts":3.000,)"
+        )
+    );
+    REQUIRE_THAT(
+        json,
+        Catch::Matchers::ContainsSubstring(
+            R"({"ph":"e","pid":2,"tid":2,"cat":"lock.hold","name":"thread 3",)"
+            R"("id":"2:3","ts":1241.567})"
+        )
+    );
+    REQUIRE_THAT(
+        json,
+        !Catch::Matchers::ContainsSubstring( R"("ph":"X","pid":2)" )
+    );
+
+    // Events are written in start order, whatever the order of the trace.
+    REQUIRE(
+        json.find( R"("id":"2:0")" ) < json.find( R"("id":"2:3")" )
+    );
+}
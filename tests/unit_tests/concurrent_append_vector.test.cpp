@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zdm/concurrent_append_vector.hpp>
+
+TEST_CASE(
+    "concurrent_append_vector - appends across segments without moving",
+    "[concurrent_append_vector]"
+)
+{
+    zdm::concurrent_append_vector<std::string> values;
+
+    REQUIRE( values.empty() );
+    REQUIRE( values.push_back( "0" ) == 0 );
+
+    const auto *first = &values[0];
+
+    for( int i = 1; i < 1000; ++i )
+    {
+        REQUIRE( values.emplace_back( std::to_string( i ) )
+                 == static_cast<std::size_t>( i ) );
+    }
+
+    REQUIRE( values.size() == 1000 );
+    REQUIRE( &values[0] == first );
+    REQUIRE( values[15] == "15" );
+    REQUIRE( values[16] == "16" );
+    REQUIRE( values.at( 999 ) == "999" );
+    REQUIRE_THROWS_AS( values.at( 1000 ), std::out_of_range );
+
+    std::size_t expected = 0;
+
+    for( const auto &value : values )
+    {
+        REQUIRE( value == std::to_string( expected++ ) );
+    }
+
+    REQUIRE( expected == 1000 );
+    REQUIRE_THROWS_AS(
+        values.reserve( std::numeric_limits<std::size_t>::max() ),
+        std::length_error
+    );
+    REQUIRE( values.size() == 1000 );
+}
+
+TEST_CASE(
+    "concurrent_append_vector - readers see fully constructed elements",
+    "[concurrent_append_vector]"
+)
+{
+    constexpr int writers          = 4;
+    constexpr int pushes_per_write = 5000;
+
+    zdm::concurrent_append_vector<std::vector<int>> values;
+    values.reserve( 64 );
+
+    std::atomic<bool> writing{ true };
+    std::atomic<bool> torn{ false };
+
+    std::thread reader(
+        [&]
+        {
+            while( writing.load() )
+            {
+                const auto size = values.size();
+
+                for( std::size_t i = 0; i < size; ++i )
+                {
+                    const auto &value = values[i];
+
+                    if( value.size() != 2 || value[0] != value[1] )
+                    {
+                        torn = true;
+                    }
+                }
+            }
+        }
+    );
+
+    std::vector<std::thread> threads;
+
+    for( int w = 0; w < writers; ++w )
+    {
+        threads.emplace_back(
+            [&values, w]
+            {
+                for( int i = 0; i < pushes_per_write; ++i )
+                {
+                    const int id = w * pushes_per_write + i;
+                    values.push_back( { id, id } );
+                }
+            }
+        );
+    }
+
+    for( auto &thread : threads )
+    {
+        thread.join();
+    }
+
+    writing = false;
+    reader.join();
+
+    REQUIRE_FALSE( torn.load() );
+    REQUIRE( values.size() == writers * pushes_per_write );
+
+    std::vector<bool> seen( writers * pushes_per_write );
+
+    for( const auto &value : values )
+    {
+        seen[static_cast<std::size_t>( value[0] )] = true;
+    }
+
+    REQUIRE( std::count( seen.begin(), seen.end(), false ) == 0 );
+}
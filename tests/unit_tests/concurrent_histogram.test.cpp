@@ -0,0 +1,121 @@
+#include <catch2/catch_all.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <zdm/concurrent_histogram.hpp>
+
+TEST_CASE(
+    "concurrent_histogram - merges the values of every thread",
+    "[concurrent_histogram]"
+)
+{
+    constexpr std::uint64_t threads_count = 4;
+    constexpr std::uint64_t values        = 10'000;
+
+    zdm::concurrent_histogram histogram;
+    std::vector<std::thread>  threads;
+
+    for( std::uint64_t t = 0; t < threads_count; ++t )
+    {
+        threads.emplace_back(
+            [&histogram, t]
+            {
+                for( std::uint64_t value = 1; value <= values; ++value )
+                {
+                    histogram.record( value + t * values );
+                }
+            }
+        );
+    }
+
+    for( std::size_t i = 0; i < 100; ++i )
+    {
+        const auto snapshot = histogram.snapshot();
+
+        std::uint64_t bucketed = 0;
+
+        for( std::size_t b = 0; b < zdm::latency_histogram::bucket_count; ++b )
+        {
+            bucketed += snapshot.bucket( b );
+        }
+
+        REQUIRE( bucketed == snapshot.count() );
+    }
+
+    for( auto &thread : threads )
+    {
+        thread.join();
+    }
+
+    const auto count = histogram.with_lock(
+        []( const zdm::latency_histogram& a_histogram )
+        {
+            return a_histogram.count();
+        }
+    );
+
+    const auto snapshot = histogram.snapshot();
+
+    REQUIRE( count == threads_count * values );
+    REQUIRE( snapshot.min() == 1 );
+    REQUIRE( snapshot.max() == threads_count * values );
+    REQUIRE( snapshot.sum() == 40'000 * 40'001 / 2 );
+    REQUIRE( snapshot.value_at_percentile( 50.0 ) >= 19'400 );
+    REQUIRE( snapshot.value_at_percentile( 50.0 ) <= 20'600 );
+}
+
+TEST_CASE(
+    "concurrent_histogram - keeps histograms recorded by one thread apart",
+    "[concurrent_histogram]"
+)
+{
+    zdm::concurrent_histogram first;
+    zdm::concurrent_histogram second;
+
+    for( std::uint64_t i = 0; i < 10; ++i )
+    {
+        first.record( 5 );
+        second.record( 7, 2 );
+    }
+
+    REQUIRE( first.snapshot().count() == 10 );
+    REQUIRE( first.snapshot().max() == 5 );
+    REQUIRE( second.snapshot().count() == 20 );
+    REQUIRE( second.snapshot().sum() == 140 );
+
+    // A histogram created after a thread recorded gets a shard of its own.
+    {
+        zdm::concurrent_histogram third;
+        third.record( 1 );
+        REQUIRE( third.snapshot().count() == 1 );
+    }
+
+    zdm::concurrent_histogram fourth;
+    fourth.record( 2 );
+
+    REQUIRE( fourth.snapshot().count() == 1 );
+    REQUIRE( fourth.snapshot().min() == 2 );
+}
+
+TEST_CASE(
+    "concurrent_histogram - histograms reusing an address start empty",
+    "[concurrent_histogram]"
+)
+{
+    zdm::concurrent_histogram kept;
+
+    for( std::uint64_t i = 0; i < 1'000; ++i )
+    {
+        auto histogram = std::make_unique<zdm::concurrent_histogram>();
+
+        histogram->record( i );
+        kept.record( i );
+
+        REQUIRE( histogram->snapshot().count() == 1 );
+        REQUIRE( histogram->snapshot().min() == i );
+    }
+
+    REQUIRE( kept.snapshot().count() == 1'000 );
+}
@@ -0,0 +1,188 @@
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <zdm/convoy_detector.hpp>
+
+namespace {
+
+zdm::instrumentation::lock_event
+release_event(
+    std::uint32_t a_wrapper,
+    std::uint32_t a_thread,
+    bool          a_contended,
+    std::uint64_t a_start_ns = 0
+)
+{
+    return {
+        .start_ns  = a_start_ns,
+        .wait_ns   = 0,
+        .hold_ns   = 0,
+        .thread    = a_thread,
+        .wrapper   = a_wrapper,
+        .mode      = zdm::instrumentation::lock_mode::exclusive,
+        .contended = a_contended,
+    };
+}
+
+} // namespace
+
+TEST_CASE(
+    "convoy_detector - scores chains of contended handoffs",
+    "[convoy_detector]"
+)
+{
+    zdm::instrumentation::convoy_detector detector( 8 );
+
+    for( std::uint32_t i = 0; i < 20; ++i )
+    {
+        detector.on_release( release_event( 1, i % 2, true ) );
+    }
+
+    for( std::uint32_t i = 0; i < 20; ++i )
+    {
+        detector.on_release( release_event( 2, i % 2, false ) );
+    }
+
+    const auto stats = detector.stats();
+
+    REQUIRE( stats.size() == 2 );
+    REQUIRE( stats[0].wrapper == 1 );
+    REQUIRE( stats[0].acquisitions == 20 );
+    REQUIRE( stats[0].contended_handoffs == 19 );
+    REQUIRE( stats[0].longest_chain == 19 );
+    REQUIRE( stats[0].convoy_acquisitions == 19 );
+    REQUIRE( stats[0].convoy_score() == Catch::Approx( 0.95 ) );
+    REQUIRE( stats[1].wrapper == 2 );
+    REQUIRE( stats[1].contended_handoffs == 0 );
+    REQUIRE( stats[1].convoy_score() == 0.0 );
+}
+
+TEST_CASE(
+    "convoy_detector - short chains are not convoys",
+    "[convoy_detector]"
+)
+{
+    zdm::instrumentation::convoy_detector detector( 8 );
+
+    for( int round = 0; round < 10; ++round )
+    {
+        for( std::uint32_t i = 0; i < 5; ++i )
+        {
+            detector.on_release( release_event( 1, i % 2, true ) );
+        }
+
+        detector.on_release( release_event( 1, 0, false ) );
+    }
+
+    const auto stats = detector.stats();
+
+    REQUIRE( stats.size() == 1 );
+    REQUIRE( stats[0].longest_chain < 8 );
+    REQUIRE( stats[0].convoy_acquisitions == 0 );
+
+    detector.reset();
+    REQUIRE( detector.stats().empty() );
+}
+
+TEST_CASE(
+    "convoy_detector - follows releases in acquisition order",
+    "[convoy_detector]"
+)
+{
+    zdm::instrumentation::convoy_detector detector( 8 );
+
+    // Three threads take turns, but report each pair of releases swapped.
+    for( std::uint32_t i = 0; i < 20; ++i )
+    {
+        const auto acquisition = i ^ 1;
+
+        detector.on_release(
+            release_event( 1, acquisition % 3, true, acquisition * 10 )
+        );
+    }
+
+    const auto stats = detector.stats();
+
+    REQUIRE( stats.size() == 1 );
+    REQUIRE( stats[0].contended_handoffs == 19 );
+    REQUIRE( stats[0].longest_chain == 19 );
+}
+
+TEST_CASE(
+    "convoy_detector - forgets destroyed wrappers",
+    "[convoy_detector]"
+)
+{
+    zdm::instrumentation::convoy_detector detector;
+
+    detector.start();
+
+    {
+        zdm::instrumented_lock_wrapper<int> wrapper( 0 );
+
+        wrapper.with_lock(
+            []( int& value )
+            {
+                ++value;
+            }
+        );
+
+        REQUIRE( detector.stats().size() == 1 );
+    }
+
+    detector.stop();
+
+    REQUIRE( detector.stats().empty() );
+}
+
+TEST_CASE(
+    "convoy_detector - detects a convoy on a contended wrapper",
+    "[convoy_detector]"
+)
+{
+    using namespace std::chrono_literals;
+
+    zdm::instrumentation::convoy_detector detector( 4 );
+    zdm::instrumented_lock_wrapper<int>   wrapper( 0 );
+
+    wrapper.mutex().set_name( "convoy" );
+    detector.start();
+
+    std::vector<std::thread> threads;
+
+    for( int t = 0; t < 4; ++t )
+    {
+        threads.emplace_back(
+            [&wrapper]()
+            {
+                for( int i = 0; i < 50; ++i )
+                {
+                    wrapper.with_lock(
+                        []( int& value )
+                        {
+                            ++value;
+                            std::this_thread::sleep_for( 100us );
+                        }
+                    );
+                }
+            }
+        );
+    }
+
+    for( auto& thread : threads )
+    {
+        thread.join();
+    }
+
+    detector.stop();
+
+    const auto stats = detector.stats();
+
+    REQUIRE( stats.size() == 1 );
+    REQUIRE( stats[0].name == "convoy" );
+    REQUIRE( stats[0].acquisitions == 200 );
+    REQUIRE( stats[0].contended_handoffs > 0 );
+    REQUIRE( stats[0].migrations <= stats[0].contended_handoffs );
+}
@@ -0,0 +1,107 @@
+#include <catch2/catch_all.hpp>
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include <zdm/cow_wrapper.hpp>
+
+TEST_CASE(
+    "cow_wrapper - snapshots do not see later changes",
+    "[cow_wrapper]"
+)
+{
+    zdm::cow_wrapper<std::vector<int>> wrapper( std::vector<int>{ 1, 2, 3 } );
+
+    const int *storage = wrapper.with_lock(
+        []( std::vector<int>& a_values )
+        {
+            a_values.push_back( 4 );
+            return a_values.data();
+        }
+    );
+
+    // Without a live snapshot, changes happen in place.
+    REQUIRE( wrapper.with_lock(
+                 []( std::vector<int>& a_values )
+                 {
+                     return a_values.data();
+                 }
+             )
+             == storage );
+
+    auto snapshot = wrapper.snapshot();
+
+    REQUIRE( snapshot->data() == storage );
+
+    wrapper.with_lock(
+        []( std::vector<int>& a_values )
+        {
+            a_values.push_back( 5 );
+        }
+    );
+
+    REQUIRE( *snapshot == std::vector<int>{ 1, 2, 3, 4 } );
+    REQUIRE( wrapper.with_lock(
+                 []( const std::vector<int>& a_values )
+                 {
+                     return a_values.size();
+                 }
+             )
+             == 5 );
+    REQUIRE( wrapper.version() == 3 );
+
+    // The first change after a snapshot copies, even once it is dropped,
+    // and later ones happen in place again.
+    snapshot.reset();
+
+    const auto *dropped = wrapper.snapshot()->data();
+    const auto  change  = []( std::vector<int>& a_values )
+    {
+        ++a_values[0];
+        return a_values.data();
+    };
+    const auto *copied  = wrapper.with_lock( change );
+
+    REQUIRE( copied != dropped );
+    REQUIRE( wrapper.with_lock( change ) == copied );
+}
+
+TEST_CASE(
+    "cow_wrapper - snapshots are consistent while writers change the state",
+    "[cow_wrapper]"
+)
+{
+    zdm::shared_cow_wrapper<std::vector<int>> wrapper;
+
+    std::thread writer(
+        [&wrapper]()
+        {
+            for( int i = 0; i < 2000; ++i )
+            {
+                wrapper.with_lock(
+                    [i]( std::vector<int>& a_values )
+                    {
+                        a_values.push_back( i );
+                    }
+                );
+            }
+        }
+    );
+
+    bool consistent = true;
+
+    for( int i = 0; i < 200; ++i )
+    {
+        const auto snapshot = wrapper.snapshot();
+
+        for( std::size_t j = 0; j < snapshot->size(); ++j )
+        {
+            consistent
+                = consistent && ( *snapshot )[j] == static_cast<int>( j );
+        }
+    }
+
+    writer.join();
+
+    REQUIRE( consistent );
+    REQUIRE( wrapper.snapshot()->size() == 2000 );
+}
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <zdm/instrumented_mutex.hpp>
+
+namespace {
+
+std::vector<zdm::instrumentation::flight_event>
+events_of(
+    std::uint32_t a_wrapper,
+    std::uint64_t a_since_ns
+)
+{
+    auto events = zdm::instrumentation::flight_recorder::snapshot( a_since_ns );
+
+    std::erase_if(
+        events,
+        [a_wrapper]( const zdm::instrumentation::flight_event& a_event )
+        {
+            return a_event.wrapper != a_wrapper;
+        }
+    );
+
+    return events;
+}
+
+} // namespace
+
+TEST_CASE(
+    "flight_recorder - keeps acquire and release events",
+    "[flight_recorder]"
+)
+{
+    using zdm::instrumentation::flight_event_kind;
+
+    const auto                          since = zdm::instrumentation::now_ns();
+    zdm::instrumented_lock_wrapper<int> wrapper( 0 );
+
+    wrapper.with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+
+    const auto events = events_of( wrapper.mutex().id(), since );
+
+    REQUIRE( events.size() == 2 );
+    REQUIRE( events[0].kind == flight_event_kind::acquire );
+    REQUIRE( events[1].kind == flight_event_kind::release );
+    REQUIRE( events[0].thread == zdm::instrumentation::thread_index() );
+    REQUIRE( events[0].time_ns <= events[1].time_ns );
+}
+
+TEST_CASE(
+    "flight_recorder - records contention",
+    "[flight_recorder]"
+)
+{
+    using zdm::instrumentation::flight_event_kind;
+
+    const auto                          since = zdm::instrumentation::now_ns();
+    zdm::instrumented_lock_wrapper<int> wrapper( 0 );
+    std::thread                         contender;
+
+    wrapper.with_lock(
+        [&]( int& )
+        {
+            contender = std::thread(
+                [&wrapper]()
+                {
+                    wrapper.with_lock(
+                        []( int& value )
+                        {
+                            ++value;
+                        }
+                    );
+                }
+            );
+
+            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        }
+    );
+
+    contender.join();
+
+    const auto events = events_of( wrapper.mutex().id(), since );
+
+    REQUIRE( events.size() == 5 );
+    REQUIRE( std::ranges::count(
+                 events,
+                 flight_event_kind::contended,
+                 &zdm::instrumentation::flight_event::kind
+             )
+             == 1 );
+}
+
+TEST_CASE(
+    "flight_recorder - keeps the latest events of each thread",
+    "[flight_recorder]"
+)
+{
+    constexpr auto capacity = zdm::detail::flight_ring::capacity;
+
+    const auto                          since = zdm::instrumentation::now_ns();
+    zdm::instrumented_lock_wrapper<int> wrapper( 0 );
+
+    std::thread(
+        [&wrapper]()
+        {
+            for( std::size_t i = 0; i < capacity; ++i )
+            {
+                wrapper.with_lock(
+                    []( int& value )
+                    {
+                        ++value;
+                    }
+                );
+            }
+        }
+    ).join();
+
+    const auto events = events_of( wrapper.mutex().id(), since );
+
+    REQUIRE( events.size() == capacity );
+    REQUIRE(
+        events.front().kind == zdm::instrumentation::flight_event_kind::acquire
+    );
+}
+
+TEST_CASE(
+    "flight_recorder - text dump names wrappers",
+    "[flight_recorder]"
+)
+{
+    zdm::instrumented_shared_lock_wrapper<int> wrapper( 0 );
+    wrapper.mutex().set_name( "flight_recorder_dump" );
+
+    wrapper.with_lock(
+        []( const int& value )
+        {
+            return value;
+        }
+    );
+
+    std::ostringstream stream;
+    zdm::instrumentation::flight_recorder::dump( stream );
+
+    REQUIRE_THAT(
+        stream.str(),
+        Catch::Matchers::ContainsSubstring( "flight_recorder_dump release s" )
+    );
+}
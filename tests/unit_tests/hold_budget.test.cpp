@@ -0,0 +1,161 @@
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <source_location>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <zdm/hold_budget.hpp>
+#include <zdm/shared_lock_wrapper.hpp>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+std::vector<zdm::hold_budget_overrun>&
+overruns()
+{
+    static std::vector<zdm::hold_budget_overrun> s_overruns;
+    return s_overruns;
+}
+
+/**
+ * @brief Collects the overruns of the current test.
+ */
+class overrun_capture
+{
+    public:
+        overrun_capture()
+            : m_previous( zdm::set_hold_budget_handler(
+                  []( const zdm::hold_budget_overrun& a_overrun ) noexcept
+                  {
+                      overruns().push_back( a_overrun );
+                  }
+              ) )
+        {
+            overruns().clear();
+        }
+
+        ~overrun_capture()
+        {
+            zdm::set_hold_budget_handler( m_previous );
+        }
+
+    private:
+        zdm::hold_budget_handler m_previous;
+};
+
+} // namespace
+
+TEST_CASE(
+    "with_lock_budget - reports an overrun with its call site",
+    "[hold_budget]"
+)
+{
+    overrun_capture        capture;
+    zdm::lock_wrapper<int> wrapper( 0 );
+    const auto             before = zdm::hold_budget_overruns();
+
+    const auto line   = std::source_location::current().line() + 1;
+    const auto result = zdm::with_lock_budget(
+        wrapper,
+        1ms,
+        []( int& value )
+        {
+            std::this_thread::sleep_for( 5ms );
+            return ++value;
+        }
+    );
+
+    REQUIRE( result == 1 );
+    REQUIRE( zdm::hold_budget_overruns() == before + 1 );
+    REQUIRE( overruns().size() == 1 );
+    REQUIRE( overruns()[0].budget == 1ms );
+    REQUIRE( overruns()[0].elapsed >= 4ms );
+    REQUIRE( overruns()[0].site.line() == line );
+    REQUIRE( std::string_view( overruns()[0].site.file_name() )
+                 .ends_with( "hold_budget.test.cpp" ) );
+}
+
+TEST_CASE(
+    "with_lock_budget - stays quiet within the budget",
+    "[hold_budget]"
+)
+{
+    overrun_capture               capture;
+    zdm::shared_lock_wrapper<int> wrapper( 41 );
+
+    zdm::with_lock_budget(
+        wrapper,
+        1s,
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+
+    const auto value = zdm::with_lock_budget(
+        std::as_const( wrapper ),
+        1s,
+        []( const int& a_value )
+        {
+            return a_value;
+        }
+    );
+
+    REQUIRE( value == 42 );
+    REQUIRE( overruns().empty() );
+}
+
+TEST_CASE(
+    "with_lock_budget - reports an overrun when the function throws",
+    "[hold_budget]"
+)
+{
+    overrun_capture        capture;
+    zdm::lock_wrapper<int> wrapper( 0 );
+
+    REQUIRE_THROWS(
+        zdm::with_lock_budget(
+            wrapper,
+            1ms,
+            []( int& ) -> int
+            {
+                std::this_thread::sleep_for( 5ms );
+                throw std::runtime_error( "failed" );
+            }
+        )
+    );
+    REQUIRE( overruns().size() == 1 );
+}
+
+TEST_CASE(
+    "with_lock_budget - handlers can not throw",
+    "[hold_budget]"
+)
+{
+    using throwing_handler = void ( * )( const zdm::hold_budget_overrun & );
+
+    STATIC_REQUIRE(
+        !std::is_convertible_v<throwing_handler, zdm::hold_budget_handler>
+    );
+
+    overrun_capture        capture;
+    zdm::lock_wrapper<int> wrapper( 0 );
+
+    zdm::with_lock_budget(
+        wrapper,
+        1ns,
+        []( int& value )
+        {
+            std::this_thread::sleep_for( 1ms );
+            ++value;
+        }
+    );
+
+    // Overruns are checked once the call returned.
+    REQUIRE( overruns().size() == 1 );
+    REQUIRE( overruns().front().elapsed >= 1ms );
+}
@@ -0,0 +1,339 @@
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zdm/instrumented_mutex.hpp>
+
+namespace {
+
+class collecting_observer : public zdm::instrumentation::observer
+{
+    public:
+        collecting_observer()
+        {
+            zdm::instrumentation::add_observer( *this );
+        }
+
+        ~collecting_observer() override
+        {
+            zdm::instrumentation::remove_observer( *this );
+        }
+
+        void
+        on_release(
+            const zdm::instrumentation::lock_event& a_event
+        ) noexcept override
+        {
+            m_events.with_lock(
+                [&]( std::vector<zdm::instrumentation::lock_event>& a_events )
+                {
+                    a_events.push_back( a_event );
+                }
+            );
+        }
+
+        std::vector<zdm::instrumentation::lock_event>
+        events_of(
+            std::uint32_t a_wrapper
+        ) const
+        {
+            return m_events.with_lock(
+                [&]( const std::vector<zdm::instrumentation::lock_event>&
+                         a_events )
+                {
+                    std::vector<zdm::instrumentation::lock_event> result;
+
+                    for( const auto& event : a_events )
+                    {
+                        if( event.wrapper == a_wrapper )
+                        {
+                            result.push_back( event );
+                        }
+                    }
+
+                    return result;
+                }
+            );
+        }
+
+    private:
+        zdm::lock_wrapper<std::vector<zdm::instrumentation::lock_event>>
+            m_events;
+};
+
+/**
+ * @brief Delays the events of other threads, and counts the events a
+ * wrapper had when it was destroyed.
+ */
+class delaying_observer : public zdm::instrumentation::observer
+{
+    public:
+        explicit delaying_observer(
+            std::thread::id a_prompt
+        )
+            : m_prompt( a_prompt )
+        {
+            zdm::instrumentation::add_observer( *this );
+        }
+
+        ~delaying_observer() override
+        {
+            zdm::instrumentation::remove_observer( *this );
+        }
+
+        void
+        on_release(
+            const zdm::instrumentation::lock_event& a_event
+        ) noexcept override
+        {
+            if( std::this_thread::get_id() != m_prompt )
+            {
+                std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+            }
+
+            if( a_event.wrapper == m_wrapper )
+            {
+                ++m_released;
+            }
+        }
+
+        void
+        on_destroy(
+            std::uint32_t a_wrapper,
+            const std::string&
+        ) noexcept override
+        {
+            if( a_wrapper == m_wrapper )
+            {
+                m_released_at_destroy = m_released.load();
+            }
+        }
+
+        std::atomic<std::uint32_t> m_wrapper{ 0 };
+        std::atomic<int>           m_released{ 0 };
+        std::atomic<int>           m_released_at_destroy{ -1 };
+
+    private:
+        std::thread::id m_prompt;
+};
+
+} // namespace
+
+TEST_CASE(
+    "instrumented_mutex - reports one event per critical section",
+    "[instrumented_mutex]"
+)
+{
+    collecting_observer                        observer;
+    zdm::instrumented_shared_lock_wrapper<int> wrapper( 0 );
+
+    wrapper.mutex().set_name( "counter" );
+
+    wrapper.with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+    wrapper.with_lock(
+        []( const int& value )
+        {
+            return value;
+        }
+    );
+
+    const auto events = observer.events_of( wrapper.mutex().id() );
+
+    REQUIRE( wrapper.mutex().name() == "counter" );
+    REQUIRE( events.size() == 2 );
+    REQUIRE( events[0].mode == zdm::instrumentation::lock_mode::exclusive );
+    REQUIRE( events[1].mode == zdm::instrumentation::lock_mode::shared );
+    REQUIRE_FALSE( events[0].contended );
+    REQUIRE( events[0].thread == zdm::instrumentation::thread_index() );
+    REQUIRE( events[1].start_ns >= events[0].start_ns + events[0].hold_ns );
+}
+
+TEST_CASE(
+    "instrumented_mutex - nested recursive locks form one critical section",
+    "[instrumented_mutex]"
+)
+{
+    collecting_observer                           observer;
+    zdm::instrumented_recursive_lock_wrapper<int> wrapper( 0 );
+
+    wrapper.with_lock(
+        [&wrapper]( int& )
+        {
+            wrapper.with_lock(
+                []( int& value )
+                {
+                    ++value;
+                }
+            );
+        }
+    );
+
+    REQUIRE( *wrapper == 1 );
+    REQUIRE( observer.events_of( wrapper.mutex().id() ).size() == 1 );
+}
+
+TEST_CASE(
+    "instrumented_mutex - observers can be removed and added again",
+    "[instrumented_mutex]"
+)
+{
+    zdm::instrumented_lock_wrapper<int> wrapper( 0 );
+    std::uint32_t                       id = wrapper.mutex().id();
+
+    {
+        collecting_observer observer;
+    }
+
+    collecting_observer observer;
+
+    wrapper.with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+
+    REQUIRE( observer.events_of( id ).size() == 1 );
+}
+
+TEST_CASE(
+    "instrumented_mutex - a wrapper is retired after its last event",
+    "[instrumented_mutex]"
+)
+{
+    delaying_observer  observer( std::this_thread::get_id() );
+    std::promise<void> locked;
+
+    auto wrapper = std::make_unique<zdm::instrumented_lock_wrapper<int>>( 0 );
+
+    observer.m_wrapper = wrapper->mutex().id();
+
+    std::thread holder(
+        [&wrapper, &locked]()
+        {
+            wrapper->with_lock(
+                [&locked]( int& value )
+                {
+                    locked.set_value();
+                    std::this_thread::sleep_for(
+                        std::chrono::milliseconds( 10 )
+                    );
+                    ++value;
+                }
+            );
+        }
+    );
+
+    locked.get_future().wait();
+
+    // Waits for the holder to unlock, then destroys the wrapper while the
+    // holder's event is still being delivered.
+    wrapper->with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+    wrapper.reset();
+    holder.join();
+
+    REQUIRE( observer.m_released_at_destroy == 2 );
+}
+
+TEST_CASE(
+    "instrumented_mutex - observers can be removed under steady traffic",
+    "[instrumented_mutex]"
+)
+{
+    zdm::instrumented_lock_wrapper<int> wrapper( 0 );
+    std::atomic<bool>                   running{ true };
+    std::vector<std::thread>            threads;
+    collecting_observer                 removed_inside;
+
+    class removing_observer : public zdm::instrumentation::observer
+    {
+        public:
+            explicit removing_observer(
+                zdm::instrumentation::observer& a_other
+            )
+                : m_other( a_other )
+            {
+            }
+
+            void
+            on_release(
+                const zdm::instrumentation::lock_event&
+            ) noexcept override
+            {
+                zdm::instrumentation::remove_observer( m_other );
+                zdm::instrumentation::remove_observer( *this );
+            }
+
+        private:
+            zdm::instrumentation::observer& m_other;
+    };
+
+    for( int t = 0; t < 4; ++t )
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                while( running )
+                {
+                    wrapper.with_lock(
+                        []( int& value )
+                        {
+                            ++value;
+                        }
+                    );
+                }
+            }
+        );
+    }
+
+    {
+        collecting_observer observer;
+    }
+
+    removing_observer remover( removed_inside );
+
+    zdm::instrumentation::add_observer( remover );
+
+    // Removes both observers from inside a callback.
+    zdm::instrumented_lock_wrapper<int> other( 0 );
+
+    other.with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+
+    running = false;
+
+    for( auto& thread : threads )
+    {
+        thread.join();
+    }
+
+    const auto before = removed_inside.events_of( other.mutex().id() ).size();
+
+    other.with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+
+    REQUIRE( removed_inside.events_of( other.mutex().id() ).size() == before );
+}
@@ -0,0 +1,75 @@
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <limits>
+#include <zdm/latency_histogram.hpp>
+
+TEST_CASE(
+    "latency_histogram - bucket bounds cover every value",
+    "[latency_histogram]"
+)
+{
+    using histogram = zdm::latency_histogram;
+
+    STATIC_REQUIRE(
+        histogram::bucket_index( std::numeric_limits<std::uint64_t>::max() )
+        == histogram::bucket_count - 1
+    );
+
+    for( std::uint64_t value = 0; value < 100'000; value += 7 )
+    {
+        const auto index = histogram::bucket_index( value );
+
+        REQUIRE( histogram::bucket_upper_bound( index ) >= value );
+
+        if( index > 0 )
+        {
+            REQUIRE( histogram::bucket_upper_bound( index - 1 ) < value );
+        }
+    }
+}
+
+TEST_CASE(
+    "latency_histogram - percentiles stay within the bucket precision",
+    "[latency_histogram]"
+)
+{
+    zdm::latency_histogram histogram;
+
+    for( std::uint64_t value = 1; value <= 10'000; ++value )
+    {
+        histogram.record( value );
+    }
+
+    REQUIRE( histogram.count() == 10'000 );
+    REQUIRE( histogram.min() == 1 );
+    REQUIRE( histogram.max() == 10'000 );
+    REQUIRE( histogram.mean() == Catch::Approx( 5'000.5 ) );
+    REQUIRE(
+        histogram.value_at_percentile( 50.0 )
+        == Catch::Approx( 5'000 ).epsilon( 0.04 )
+    );
+    REQUIRE(
+        histogram.value_at_percentile( 99.0 )
+        == Catch::Approx( 9'900 ).epsilon( 0.04 )
+    );
+    REQUIRE( histogram.value_at_percentile( 100.0 ) == 10'000 );
+}
+
+TEST_CASE(
+    "latency_histogram - merge",
+    "[latency_histogram]"
+)
+{
+    zdm::latency_histogram first;
+    zdm::latency_histogram second;
+
+    first.record( 10 );
+    second.record( 1'000, 3 );
+    first.merge( second );
+
+    REQUIRE( first.count() == 4 );
+    REQUIRE( first.sum() == 3'010 );
+    REQUIRE( first.min() == 10 );
+    REQUIRE( first.value_at_percentile( 25.0 ) == 10 );
+    REQUIRE( first.value_at_percentile( 50.0 ) == 1'000 );
+}
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <catch2/catch_all.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zdm/lock_trace.hpp>
+
+TEST_CASE(
+    "trace_recorder - records events from every thread",
+    "[lock_trace]"
+)
+{
+    zdm::instrumentation::trace_recorder recorder;
+    zdm::instrumented_lock_wrapper<int>  wrapper( 0 );
+
+    wrapper.mutex().set_name( "traced" );
+    recorder.start();
+
+    std::vector<std::thread> threads;
+
+    for( int t = 0; t < 4; ++t )
+    {
+        threads.emplace_back(
+            [&wrapper]()
+            {
+                for( int i = 0; i < 100; ++i )
+                {
+                    wrapper.with_lock(
+                        []( int& value )
+                        {
+                            ++value;
+                        }
+                    );
+                }
+            }
+        );
+    }
+
+    for( auto& thread : threads )
+    {
+        thread.join();
+    }
+
+    auto trace = recorder.take();
+
+    std::erase_if(
+        trace.events,
+        [&]( const zdm::instrumentation::lock_event& a_event )
+        {
+            return a_event.wrapper != wrapper.mutex().id();
+        }
+    );
+
+    REQUIRE( trace.events.size() == 400 );
+    REQUIRE( std::ranges::is_sorted(
+        trace.events,
+        {},
+        &zdm::instrumentation::lock_event::start_ns
+    ) );
+    REQUIRE(
+        std::ranges::count(
+            trace.wrappers,
+            std::pair<std::uint32_t, std::string>(
+                wrapper.mutex().id(),
+                "traced"
+            )
+        )
+        == 1
+    );
+    REQUIRE( recorder.dropped() == 0 );
+}
+
+TEST_CASE(
+    "lock_trace - binary round trip",
+    "[lock_trace]"
+)
+{
+    zdm::instrumentation::lock_trace trace;
+    trace.wrappers = { { 1, "first" }, { 7, "" } };
+    trace.events   = {
+        { .start_ns = 1'000,
+          .wait_ns  = 0,
+          .hold_ns  = 250,
+          .thread   = 0,
+          .wrapper  = 1 },
+        { .start_ns  = 1'100,
+          .wait_ns   = 150,
+          .hold_ns   = 1'000'000'000'000,
+          .thread    = 3,
+          .wrapper   = 7,
+          .mode      = zdm::instrumentation::lock_mode::shared,
+          .contended = true },
+    };
+
+    std::stringstream stream;
+    zdm::instrumentation::write_trace( stream, trace );
+
+    const auto read = zdm::instrumentation::read_trace( stream );
+
+    REQUIRE( read.wrappers == trace.wrappers );
+    REQUIRE( read.events == trace.events );
+
+    std::stringstream garbage( "not a trace" );
+    REQUIRE_THROWS_AS(
+        zdm::instrumentation::read_trace( garbage ),
+        std::runtime_error
+    );
+}
+
+TEST_CASE(
+    "trace_recorder - recorders used in turn and destroyed wrappers",
+    "[lock_trace]"
+)
+{
+    zdm::instrumentation::trace_recorder first;
+    zdm::instrumentation::trace_recorder second;
+    std::uint32_t                        id = 0;
+
+    first.start();
+    second.start();
+
+    {
+        zdm::instrumented_lock_wrapper<int> wrapper( 0 );
+
+        wrapper.mutex().set_name( "short lived" );
+        id = wrapper.mutex().id();
+
+        for( int i = 0; i < 10; ++i )
+        {
+            wrapper.with_lock(
+                []( int& value )
+                {
+                    ++value;
+                }
+            );
+        }
+    }
+
+    REQUIRE( zdm::instrumentation::wrapper_name( id ).empty() );
+
+    for( auto* recorder : { &first, &second } )
+    {
+        const auto trace = recorder->take();
+
+        REQUIRE(
+            std::ranges::count(
+                trace.events,
+                id,
+                &zdm::instrumentation::lock_event::wrapper
+            )
+            == 10
+        );
+        REQUIRE(
+            std::ranges::count(
+                trace.wrappers,
+                std::pair<std::uint32_t, std::string>( id, "short lived" )
+            )
+            == 1
+        );
+    }
+}
+
+TEST_CASE(
+    "lock_trace - rejects oversized and truncated names",
+    "[lock_trace]"
+)
+{
+    zdm::instrumentation::lock_trace trace;
+    trace.wrappers = { { 1, std::string( 10'000, 'x' ) } };
+
+    std::stringstream stream;
+    zdm::instrumentation::write_trace( stream, trace );
+
+    REQUIRE(
+        zdm::instrumentation::read_trace( stream ).wrappers[0].second.size()
+        == zdm::detail::trace_max_name_size
+    );
+
+    const auto header
+        = std::string(
+              zdm::detail::trace_magic.begin(),
+              zdm::detail::trace_magic.end()
+          )
+        + static_cast<char>( zdm::detail::trace_version );
+
+    std::stringstream oversized( header + "\x01\x01\xFF\xFF\xFF\xFF\x0F" );
+    REQUIRE_THROWS_AS(
+        zdm::instrumentation::read_trace( oversized ),
+        std::runtime_error
+    );
+
+    std::stringstream truncated( header + "\x01\x01\x05" "abc" );
+    REQUIRE_THROWS_AS(
+        zdm::instrumentation::read_trace( truncated ),
+        std::runtime_error
+    );
+}
@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <source_location>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <zdm/instrumented_mutex.hpp>
+
+namespace {
+
+using namespace std::chrono_literals;
+using zdm::instrumentation::lock_phase;
+using zdm::instrumentation::slow_lock_report;
+
+/**
+ * @brief Collects the reports of one wrapper.
+ */
+class report_collector
+{
+    public:
+        explicit report_collector(
+            std::uint32_t a_wrapper
+        )
+            : m_wrapper( a_wrapper )
+        {
+        }
+
+        void
+        operator()(
+            const slow_lock_report& a_report
+        )
+        {
+            if( a_report.wrapper != m_wrapper )
+            {
+                return;
+            }
+
+            {
+                std::scoped_lock lock( m_mutex );
+                m_reports.push_back( a_report );
+            }
+
+            m_condition.notify_all();
+        }
+
+        bool
+        wait_for(
+            lock_phase a_phase
+        )
+        {
+            std::unique_lock lock( m_mutex );
+            return m_condition.wait_for(
+                lock,
+                10s,
+                [this, a_phase]()
+                {
+                    return std::ranges::any_of(
+                        m_reports,
+                        [a_phase]( const slow_lock_report& a_report )
+                        {
+                            return a_report.phase == a_phase;
+                        }
+                    );
+                }
+            );
+        }
+
+        std::vector<slow_lock_report>
+        reports()
+        {
+            std::scoped_lock lock( m_mutex );
+            return m_reports;
+        }
+
+    private:
+        std::uint32_t                 m_wrapper;
+        std::mutex                    m_mutex;
+        std::condition_variable       m_condition;
+        std::vector<slow_lock_report> m_reports;
+};
+
+} // namespace
+
+TEST_CASE(
+    "lock_watchdog - reports a long hold once, with its site",
+    "[lock_watchdog]"
+)
+{
+    zdm::instrumented_lock_wrapper<int> wrapper( 0 );
+    report_collector                    collector( wrapper.mutex().id() );
+
+    wrapper.mutex().set_name( "slow" );
+
+    zdm::instrumentation::lock_watchdog watchdog(
+        5ms,
+        [&collector]( const slow_lock_report& a_report )
+        {
+            collector( a_report );
+        },
+        1ms
+    );
+
+    const auto line = std::source_location::current().line() + 1;
+    wrapper.with_lock(
+        [&collector]( int& )
+        {
+            REQUIRE( collector.wait_for( lock_phase::holding ) );
+            std::this_thread::sleep_for( 20ms );
+        }
+    );
+
+    const auto reports = collector.reports();
+
+    REQUIRE( reports.size() == 1 );
+    REQUIRE( reports[0].name == "slow" );
+    REQUIRE( reports[0].thread == zdm::instrumentation::thread_index() );
+    REQUIRE( reports[0].mode == zdm::instrumentation::lock_mode::exclusive );
+    REQUIRE( reports[0].elapsed >= 5ms );
+    REQUIRE( reports[0].site.line == line );
+    REQUIRE( std::string_view( reports[0].site.file )
+                 .ends_with( "lock_watchdog.test.cpp" ) );
+}
+
+TEST_CASE(
+    "lock_watchdog - reports a long wait",
+    "[lock_watchdog]"
+)
+{
+    zdm::instrumented_shared_lock_wrapper<int> wrapper( 0 );
+    const auto                                 id = wrapper.mutex().id();
+    report_collector                           collector( id );
+    std::atomic<bool>                          held{ false };
+    std::atomic<bool>                          reported{ false };
+    std::atomic<std::uint32_t>                 waiter{ 0 };
+
+    zdm::instrumentation::lock_watchdog watchdog(
+        5ms,
+        [&collector]( const slow_lock_report& a_report )
+        {
+            collector( a_report );
+        },
+        1ms
+    );
+
+    std::thread holder(
+        [&]()
+        {
+            wrapper.with_lock(
+                [&]( int& )
+                {
+                    held     = true;
+                    reported = collector.wait_for( lock_phase::waiting );
+                }
+            );
+        }
+    );
+
+    while( !held )
+    {
+        std::this_thread::yield();
+    }
+
+    std::thread reader(
+        [&]()
+        {
+            waiter = zdm::instrumentation::thread_index();
+            std::as_const( wrapper ).with_lock(
+                []( const int& )
+                {
+                }
+            );
+        }
+    );
+
+    holder.join();
+    reader.join();
+
+    REQUIRE( reported );
+
+    const auto reports = collector.reports();
+    const auto wait    = std::ranges::find(
+        reports,
+        lock_phase::waiting,
+        &slow_lock_report::phase
+    );
+
+    REQUIRE( wait != reports.end() );
+    REQUIRE( wait->thread == waiter );
+    REQUIRE( wait->mode == zdm::instrumentation::lock_mode::shared );
+}
+
+TEST_CASE(
+    "lock_watchdog - ignores short critical sections",
+    "[lock_watchdog]"
+)
+{
+    zdm::instrumented_lock_wrapper<int> wrapper( 0 );
+    report_collector                    collector( wrapper.mutex().id() );
+
+    {
+        zdm::instrumentation::lock_watchdog watchdog(
+            50ms,
+            [&collector]( const slow_lock_report& a_report )
+            {
+                collector( a_report );
+            },
+            1ms
+        );
+
+        const auto end = std::chrono::steady_clock::now() + 20ms;
+
+        while( std::chrono::steady_clock::now() < end )
+        {
+            wrapper.with_lock(
+                []( int& value )
+                {
+                    ++value;
+                }
+            );
+        }
+    }
+
+    REQUIRE( collector.reports().empty() );
+}
+
+TEST_CASE(
+    "lock_watchdog - a failed try_with_lock leaves no site behind",
+    "[lock_watchdog]"
+)
+{
+    zdm::instrumented_lock_wrapper<int> wrapper( 0 );
+    zdm::instrumentation::lock_watchdog watchdog(
+        1s,
+        []( const slow_lock_report& )
+        {
+        },
+        1ms
+    );
+
+    std::promise<void> locked;
+    std::promise<void> release;
+
+    std::thread holder(
+        [&]()
+        {
+            wrapper.with_lock(
+                [&]( int& )
+                {
+                    locked.set_value();
+                    release.get_future().wait();
+                }
+            );
+        }
+    );
+
+    locked.get_future().wait();
+
+    REQUIRE_FALSE( wrapper.try_with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    ) );
+    REQUIRE( zdm::detail::pending_acquisition_site().line == 0 );
+
+    release.set_value();
+    holder.join();
+}
@@ -1,7 +1,10 @@
 #include <catch2/catch_all.hpp>
+#include <optional>
 #include <ranges>
 #include <thread>
+#include <vector>
 #include <zdm/lock_wrapper.hpp>
+#include <zdm/shared_lock_wrapper.hpp>
 
 namespace {
 
@@ -93,7 +96,7 @@ TEST_CASE(
 }
 
 TEST_CASE(
-    "lock_wrapper with std::mutex - const function reference",
+    "lock_wrapper with std::mutex - const function pointer",
     "[lock_wrapper]"
 )
 {
@@ -144,3 +147,156 @@ TEST_CASE(
 
     REQUIRE( *wrapper == 100 );
 }
+
+TEST_CASE(
+    "lock_wrapper with std::mutex - named lambda",
+    "[lock_wrapper]"
+)
+{
+    zdm::lock_wrapper<int> wrapper( 42 );
+
+    const auto             increment = []( int& value )
+    {
+        value += 1;
+    };
+
+    wrapper.with_lock( increment );
+
+    REQUIRE( *wrapper == 43 );
+}
+
+TEST_CASE(
+    "lock_wrapper - try_with_lock",
+    "[lock_wrapper]"
+)
+{
+    zdm::shared_lock_wrapper<int> wrapper( 42 );
+
+    auto                          incremented = wrapper.try_with_lock(
+        []( int& value )
+        {
+            return ++value;
+        }
+    );
+
+    REQUIRE( incremented == 43 );
+    REQUIRE( wrapper.try_with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    ) );
+
+    std::optional<int> contended_result = 0;
+
+    std::thread        holder(
+        [&]()
+        {
+            wrapper.with_lock(
+                [&]( int& )
+                {
+                    std::thread contender(
+                        [&]()
+                        {
+                            contended_result = wrapper.try_with_lock(
+                                []( const int& value )
+                                {
+                                    return value;
+                                }
+                            );
+                        }
+                    );
+                    contender.join();
+                }
+            );
+        }
+    );
+    holder.join();
+
+    REQUIRE_FALSE( contended_result.has_value() );
+    REQUIRE( *wrapper == 44 );
+}
+
+TEST_CASE(
+    "lock_wrapper - locked_view holds the lock while iterating",
+    "[lock_wrapper]"
+)
+{
+    zdm::shared_lock_wrapper<std::vector<int>> wrapper(
+        std::vector<int>{ 1, 2, 3, 4, 5, 6 }
+    );
+
+    {
+        auto view = wrapper.locked_view();
+
+        STATIC_REQUIRE( std::ranges::range<decltype( view )> );
+        REQUIRE( view.size() == 6 );
+        REQUIRE_FALSE( view.empty() );
+        REQUIRE( &*view.begin() == wrapper->data() );
+
+        bool exclusive = true;
+        bool shared    = false;
+
+        std::thread(
+            [&]()
+            {
+                exclusive = wrapper.try_with_lock(
+                    []( std::vector<int>& values )
+                    {
+                        values.clear();
+                    }
+                );
+                shared = wrapper.try_with_lock(
+                    []( const std::vector<int>& )
+                    {
+                    }
+                );
+            }
+        ).join();
+
+        REQUIRE_FALSE( exclusive );
+        REQUIRE( shared );
+    }
+
+    const auto is_even = []( int value )
+    {
+        return value % 2 == 0;
+    };
+
+    std::vector<int> evens;
+
+    for( const int value :
+         wrapper.locked_view() | std::views::filter( is_even ) )
+    {
+        evens.push_back( value );
+    }
+
+    REQUIRE( evens == std::vector<int>{ 2, 4, 6 } );
+    REQUIRE( wrapper.try_with_lock(
+        []( std::vector<int>& values )
+        {
+            values.push_back( 7 );
+        }
+    ) );
+
+    zdm::lock_wrapper<std::vector<int>> exclusive_wrapper(
+        std::vector<int>{ 1, 2, 3 }
+    );
+
+    const auto view = exclusive_wrapper.locked_view();
+    bool       locked = true;
+
+    std::thread(
+        [&]()
+        {
+            locked = exclusive_wrapper.try_with_lock(
+                []( const std::vector<int>& )
+                {
+                }
+            );
+        }
+    ).join();
+
+    REQUIRE_FALSE( locked );
+    REQUIRE( std::ranges::distance( view ) == 3 );
+}
@@ -0,0 +1,293 @@
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <zdm/metrics_registry.hpp>
+
+TEST_CASE(
+    "metrics_registry - exports acquisitions of named wrappers",
+    "[metrics_registry]"
+)
+{
+    zdm::instrumentation::metrics_registry     registry;
+    zdm::instrumented_shared_lock_wrapper<int> wrapper( 0 );
+    zdm::instrumented_lock_wrapper<int>        unnamed( 0 );
+
+    wrapper.mutex().set_name( "metrics \"cache\"" );
+    registry.start();
+
+    for( int i = 0; i < 3; ++i )
+    {
+        wrapper.with_lock(
+            []( int& value )
+            {
+                ++value;
+            }
+        );
+    }
+
+    std::as_const( wrapper ).with_lock(
+        []( const int& )
+        {
+        }
+    );
+    unnamed.with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+    registry.stop();
+
+    const auto text = registry.render();
+
+    REQUIRE_THAT(
+        text,
+        Catch::Matchers::ContainsSubstring(
+            "# TYPE zdm_lock_acquisitions_total counter\n"
+            "zdm_lock_acquisitions_total{wrapper=\"metrics \\\"cache\\\"\","
+            "mode=\"exclusive\"} 3\n"
+            "zdm_lock_acquisitions_total{wrapper=\"metrics \\\"cache\\\"\","
+            "mode=\"shared\"} 1\n"
+        )
+    );
+    REQUIRE_THAT(
+        text,
+        Catch::Matchers::ContainsSubstring(
+            "zdm_lock_contended_total{wrapper=\"metrics \\\"cache\\\"\"} 0\n"
+        )
+    );
+    REQUIRE_THAT(
+        text,
+        Catch::Matchers::ContainsSubstring(
+            "zdm_lock_hold_seconds_bucket{wrapper=\"metrics \\\"cache\\\"\","
+            "le=\"+Inf\"} 4\n"
+        )
+    );
+    REQUIRE_THAT(
+        text,
+        Catch::Matchers::ContainsSubstring(
+            "zdm_lock_wait_seconds_count{wrapper=\"metrics \\\"cache\\\"\"} 4\n"
+        )
+    );
+    REQUIRE( text.find( "wrapper=\"\"" ) == std::string::npos );
+}
+
+TEST_CASE(
+    "metrics_registry - merges threads and reports contention",
+    "[metrics_registry]"
+)
+{
+    zdm::instrumentation::metrics_registry registry;
+    zdm::instrumented_lock_wrapper<int>    wrapper( 0 );
+
+    wrapper.mutex().set_name( "metrics_contended" );
+    registry.start();
+
+    std::vector<std::thread> threads;
+
+    for( int t = 0; t < 4; ++t )
+    {
+        threads.emplace_back(
+            [&wrapper]()
+            {
+                for( int i = 0; i < 1000; ++i )
+                {
+                    wrapper.with_lock(
+                        []( int& value )
+                        {
+                            ++value;
+                        }
+                    );
+                }
+            }
+        );
+    }
+
+    for( auto& thread : threads )
+    {
+        thread.join();
+    }
+
+    registry.stop();
+
+    const auto text = registry.render();
+
+    REQUIRE_THAT(
+        text,
+        Catch::Matchers::ContainsSubstring(
+            "zdm_lock_acquisitions_total{wrapper=\"metrics_contended\","
+            "mode=\"exclusive\"} 4000\n"
+        )
+    );
+    REQUIRE_THAT(
+        text,
+        Catch::Matchers::ContainsSubstring(
+            "zdm_lock_contention_ratio{wrapper=\"metrics_contended\"} "
+        )
+    );
+    REQUIRE_THAT(
+        text,
+        Catch::Matchers::ContainsSubstring(
+            "zdm_lock_hold_seconds_bucket{wrapper=\"metrics_contended\","
+            "le=\"2.5\"} 4000\n"
+        )
+    );
+}
+
+TEST_CASE(
+    "metrics_registry - writes the metrics to a file",
+    "[metrics_registry]"
+)
+{
+    zdm::instrumentation::metrics_registry registry;
+    const auto                             path
+        = std::filesystem::temp_directory_path() / "zdm_metrics_test.prom";
+
+    REQUIRE( registry.write_file( path ) );
+
+    std::ifstream     stream( path );
+    const std::string text(
+        ( std::istreambuf_iterator<char>( stream ) ),
+        std::istreambuf_iterator<char>()
+    );
+
+    REQUIRE( text == registry.render() );
+    std::filesystem::remove( path );
+
+    // Renaming over a directory fails, and the temporary file is removed.
+    const auto directory
+        = std::filesystem::temp_directory_path() / "zdm_metrics_test_dir";
+
+    std::filesystem::create_directory( directory );
+
+    REQUIRE_FALSE( registry.write_file( directory ) );
+
+    std::size_t temporaries = 0;
+
+    for( const auto& entry :
+         std::filesystem::directory_iterator( directory.parent_path() ) )
+    {
+        const auto name = entry.path().filename().string();
+
+        if( name.starts_with( "zdm_metrics_test" )
+            && name.find( ".tmp" ) != std::string::npos )
+        {
+            ++temporaries;
+        }
+    }
+
+    REQUIRE( temporaries == 0 );
+    std::filesystem::remove( directory );
+}
+
+TEST_CASE(
+    "metrics_registry - keeps the metrics of destroyed named wrappers",
+    "[metrics_registry]"
+)
+{
+    zdm::instrumentation::metrics_registry first;
+    zdm::instrumentation::metrics_registry second;
+
+    first.start();
+    second.start();
+
+    for( int round = 0; round < 2; ++round )
+    {
+        zdm::instrumented_lock_wrapper<int> wrapper( 0 );
+        zdm::instrumented_lock_wrapper<int> unnamed( 0 );
+
+        wrapper.mutex().set_name( "retired" );
+
+        for( int i = 0; i < 5; ++i )
+        {
+            wrapper.with_lock(
+                []( int& value )
+                {
+                    ++value;
+                }
+            );
+            unnamed.with_lock(
+                []( int& value )
+                {
+                    ++value;
+                }
+            );
+        }
+    }
+
+    for( const auto* registry : { &first, &second } )
+    {
+        REQUIRE_THAT(
+            registry->render(),
+            Catch::Matchers::ContainsSubstring(
+                "zdm_lock_acquisitions_total{wrapper=\"retired\","
+                "mode=\"exclusive\"} 10\n"
+            )
+        );
+    }
+}
+
+TEST_CASE(
+    "metrics_registry - counters of destroyed wrappers never go backwards",
+    "[metrics_registry]"
+)
+{
+    zdm::instrumentation::metrics_registry registry;
+    std::atomic<bool>                      done{ false };
+    std::uint64_t                          rounds = 0;
+
+    registry.start();
+
+    std::thread churn(
+        [&done, &rounds]()
+        {
+            while( !done )
+            {
+                zdm::instrumented_lock_wrapper<int> wrapper( 0 );
+
+                wrapper.mutex().set_name( "churn" );
+                wrapper.with_lock(
+                    []( int& value )
+                    {
+                        ++value;
+                    }
+                );
+                ++rounds;
+            }
+        }
+    );
+
+    const std::string counter
+        = "zdm_lock_acquisitions_total{wrapper=\"churn\",mode=\"exclusive\"} ";
+    const auto count = [&registry, &counter]()
+    {
+        const auto text  = registry.render();
+        const auto found = text.find( counter );
+
+        return found == std::string::npos
+                 ? std::uint64_t{ 0 }
+                 : std::stoull( text.substr( found + counter.size() ) );
+    };
+    std::uint64_t last = 0;
+
+    for( int i = 0; i < 500; ++i )
+    {
+        const auto value = count();
+
+        REQUIRE( value >= last );
+        last = value;
+    }
+
+    done = true;
+    churn.join();
+
+    REQUIRE( count() == rounds );
+}
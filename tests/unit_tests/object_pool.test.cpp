@@ -0,0 +1,144 @@
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <zdm/object_pool.hpp>
+
+TEST_CASE(
+    "object_pool - reuses returned objects",
+    "[object_pool]"
+)
+{
+    zdm::object_pool<std::vector<int>> pool(
+        4,
+        []
+        {
+            return std::make_unique<std::vector<int>>( 16 );
+        }
+    );
+
+    const std::vector<int> *first = nullptr;
+
+    {
+        auto buffer = pool.acquire();
+        REQUIRE( buffer );
+        REQUIRE( buffer->size() == 16 );
+        first = buffer.get();
+    }
+
+    auto again = pool.acquire();
+    REQUIRE( again.get() == first );
+    REQUIRE( pool.created() == 1 );
+
+    auto moved = std::move( again );
+    REQUIRE_FALSE( again );
+    moved.reset();
+    REQUIRE_FALSE( moved );
+
+    std::vector<zdm::object_pool<std::vector<int>>::handle> held;
+
+    for( int i = 0; i < 10; ++i )
+    {
+        held.push_back( pool.acquire() );
+    }
+
+    REQUIRE( pool.created() == 10 );
+
+    held.clear();
+
+    for( int i = 0; i < 10; ++i )
+    {
+        held.push_back( pool.acquire() );
+    }
+
+    // The objects spilled past the cache come back from the overflow list.
+    REQUIRE( pool.created() == 10 );
+}
+
+TEST_CASE(
+    "object_pool - recycles objects released by other threads",
+    "[object_pool]"
+)
+{
+    using pool_type = zdm::object_pool<std::vector<int>>;
+
+    pool_type pool( 8 );
+
+    std::vector<pool_type::handle> produced;
+
+    for( int i = 0; i < 64; ++i )
+    {
+        produced.push_back( pool.acquire() );
+    }
+
+    // A thread releases every object, filling its cache and the overflow
+    // list, then exits.
+    std::thread( [&produced] { produced.clear(); } ).join();
+
+    std::vector<pool_type::handle> consumed;
+
+    for( int i = 0; i < 64; ++i )
+    {
+        consumed.push_back( pool.acquire() );
+    }
+
+    REQUIRE( pool.created() == 64 );
+
+    std::atomic<bool>        shared{ false };
+    std::vector<std::thread> threads;
+
+    consumed.clear();
+
+    for( int t = 0; t < 4; ++t )
+    {
+        threads.emplace_back(
+            [&pool, &shared]
+            {
+                for( int i = 0; i < 10'000; ++i )
+                {
+                    auto buffer = pool.acquire();
+
+                    if( !buffer->empty() )
+                    {
+                        shared = true;
+                    }
+
+                    buffer->push_back( i );
+                    buffer->clear();
+                }
+            }
+        );
+    }
+
+    for( auto &thread : threads )
+    {
+        thread.join();
+    }
+
+    REQUIRE_FALSE( shared.load() );
+    REQUIRE( pool.created() <= 68 );
+}
+
+TEST_CASE(
+    "object_pool - pools used in turn keep their caches apart",
+    "[object_pool]"
+)
+{
+    zdm::object_pool<int> kept;
+
+    for( int i = 0; i < 1'000; ++i )
+    {
+        auto pool = std::make_unique<zdm::object_pool<int>>();
+
+        pool->acquire().reset();
+        kept.acquire().reset();
+        pool->acquire().reset();
+
+        REQUIRE( pool->created() == 1 );
+    }
+
+    REQUIRE( kept.created() == 1 );
+}
@@ -0,0 +1,260 @@
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <zdm/observable_wrapper.hpp>
+
+TEST_CASE(
+    "observable_wrapper - notifies subscribers after the lock is released",
+    "[observable_wrapper]"
+)
+{
+    zdm::observable_wrapper<int> wrapper( 0 );
+
+    std::vector<std::uint64_t> versions;
+    int                        seen = -1;
+
+    const auto id = wrapper.subscribe(
+        [&]( std::uint64_t a_version )
+        {
+            versions.push_back( a_version );
+
+            // Would deadlock if the lock were still held.
+            seen = wrapper.with_lock(
+                []( const int& a_value )
+                {
+                    return a_value;
+                }
+            );
+        }
+    );
+
+    const auto result = wrapper.with_lock(
+        []( int& a_value )
+        {
+            return ++a_value;
+        }
+    );
+
+    REQUIRE( result == 1 );
+    REQUIRE( seen == 1 );
+    REQUIRE( versions == std::vector<std::uint64_t>{ 1 } );
+
+    wrapper.with_lock(
+        []( const int& )
+        {
+        }
+    );
+
+    REQUIRE( versions.size() == 1 );
+
+    wrapper.unsubscribe( id );
+    wrapper.with_lock(
+        []( int& a_value )
+        {
+            ++a_value;
+        }
+    );
+
+    REQUIRE( versions.size() == 1 );
+    REQUIRE( wrapper.version() == 2 );
+}
+
+TEST_CASE(
+    "observable_wrapper - coalesces a burst of changes on a pool",
+    "[observable_wrapper]"
+)
+{
+    zdm::thread_pool           pool( 1 );
+    std::atomic<int>           notifications{ 0 };
+    std::atomic<std::uint64_t> last_version{ 0 };
+    std::promise<void>         unblock;
+    std::shared_future<void>   blocked = unblock.get_future().share();
+
+    {
+        zdm::observable_wrapper<int> wrapper( pool, 0 );
+
+        wrapper.subscribe(
+            [&]( std::uint64_t a_version )
+            {
+                ++notifications;
+                last_version = a_version;
+            }
+        );
+
+        // Keeps the only pool thread busy while the burst is made.
+        pool.submit(
+            [blocked]()
+            {
+                blocked.wait();
+            }
+        );
+
+        std::vector<std::thread> threads;
+
+        for( int t = 0; t < 4; ++t )
+        {
+            threads.emplace_back(
+                [&wrapper]()
+                {
+                    for( int i = 0; i < 25; ++i )
+                    {
+                        wrapper.with_lock(
+                            []( int& a_value )
+                            {
+                                ++a_value;
+                            }
+                        );
+                    }
+                }
+            );
+        }
+
+        for( auto &thread : threads )
+        {
+            thread.join();
+        }
+
+        REQUIRE( notifications == 0 );
+        unblock.set_value();
+    }
+
+    REQUIRE( notifications == 1 );
+    REQUIRE( last_version == 100 );
+}
+
+TEST_CASE(
+    "observable_wrapper - returns references to the contained object",
+    "[observable_wrapper]"
+)
+{
+    zdm::observable_wrapper<int> wrapper( 0 );
+
+    const int *address = nullptr;
+    int       &value   = wrapper.with_lock(
+        [&address]( int& a_value ) -> int&
+        {
+            address = &a_value;
+            return a_value;
+        }
+    );
+
+    REQUIRE( &value == address );
+    REQUIRE( wrapper.version() == 1 );
+}
+
+TEST_CASE(
+    "observable_wrapper - discards exceptions thrown by subscribers",
+    "[observable_wrapper]"
+)
+{
+    zdm::thread_pool pool( 1 );
+    std::atomic<int> calls{ 0 };
+
+    {
+        zdm::observable_wrapper<int> direct( 0 );
+        zdm::observable_wrapper<int> pooled( pool, 0 );
+
+        for( auto *wrapper : { &direct, &pooled } )
+        {
+            wrapper->subscribe(
+                []( std::uint64_t )
+                {
+                    throw std::runtime_error( "subscriber failed" );
+                }
+            );
+            wrapper->subscribe(
+                [&calls]( std::uint64_t )
+                {
+                    ++calls;
+                }
+            );
+        }
+
+        for( auto *wrapper : { &direct, &pooled } )
+        {
+            REQUIRE_NOTHROW( wrapper->with_lock(
+                []( int& a_value )
+                {
+                    ++a_value;
+                }
+            ) );
+        }
+    }
+
+    REQUIRE( calls == 2 );
+}
+
+TEST_CASE(
+    "observable_wrapper - delivers the last change without a pool",
+    "[observable_wrapper]"
+)
+{
+    std::atomic<std::uint64_t> last_version{ 0 };
+
+    zdm::observable_wrapper<int> wrapper( 0 );
+
+    wrapper.subscribe(
+        [&]( std::uint64_t a_version )
+        {
+            last_version = a_version;
+
+            // Changes made by a subscriber are delivered again.
+            if( a_version == 1 )
+            {
+                wrapper.with_lock(
+                    []( int& a_value )
+                    {
+                        ++a_value;
+                    }
+                );
+            }
+        }
+    );
+
+    wrapper.with_lock(
+        []( int& a_value )
+        {
+            ++a_value;
+        }
+    );
+
+    REQUIRE( last_version == 2 );
+
+    std::vector<std::thread> threads;
+
+    for( int t = 0; t < 4; ++t )
+    {
+        threads.emplace_back(
+            [&wrapper]()
+            {
+                for( int i = 0; i < 25; ++i )
+                {
+                    wrapper.with_lock(
+                        []( int& a_value )
+                        {
+                            ++a_value;
+                        }
+                    );
+                }
+            }
+        );
+    }
+
+    for( auto &thread : threads )
+    {
+        thread.join();
+    }
+
+    REQUIRE( last_version == 102 );
+    REQUIRE( wrapper.with_lock(
+                 []( const int& a_value )
+                 {
+                     return a_value;
+                 }
+             )
+             == 102 );
+}
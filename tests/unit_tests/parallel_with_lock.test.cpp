@@ -0,0 +1,305 @@
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <cstddef>
+#include <future>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <zdm/parallel_with_lock.hpp>
+#include <zdm/shared_lock_wrapper.hpp>
+
+TEST_CASE(
+    "parallel_with_lock - visits every wrapper once",
+    "[parallel_with_lock]"
+)
+{
+    zdm::thread_pool                    pool( 4 );
+    std::vector<zdm::lock_wrapper<int>> wrappers( 10'000 );
+
+    zdm::parallel_with_lock(
+        wrappers,
+        []( int& value )
+        {
+            ++value;
+        },
+        { .pool = &pool, .chunk_size = 64 }
+    );
+
+    for( auto& wrapper : wrappers )
+    {
+        REQUIRE( *wrapper == 1 );
+    }
+}
+
+TEST_CASE(
+    "parallel_with_lock - revisits wrappers that are busy",
+    "[parallel_with_lock]"
+)
+{
+    zdm::thread_pool                    pool( 2 );
+    std::vector<zdm::lock_wrapper<int>> wrappers( 100 );
+    std::thread                         holder;
+
+    wrappers[50].with_lock(
+        [&]( int& )
+        {
+            holder = std::thread(
+                [&]()
+                {
+                    zdm::parallel_with_lock(
+                        wrappers,
+                        []( int& value )
+                        {
+                            ++value;
+                        },
+                        { .pool = &pool, .chunk_size = 8, .try_passes = 3 }
+                    );
+                }
+            );
+
+            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        }
+    );
+
+    holder.join();
+
+    for( auto& wrapper : wrappers )
+    {
+        REQUIRE( *wrapper == 1 );
+    }
+}
+
+TEST_CASE(
+    "parallel_with_lock - rethrows the first exception",
+    "[parallel_with_lock]"
+)
+{
+    zdm::thread_pool                           pool( 2 );
+    std::vector<zdm::shared_lock_wrapper<int>> wrappers( 1'000 );
+
+    REQUIRE_THROWS_AS(
+        zdm::parallel_with_lock(
+            wrappers,
+            []( const int& )
+            {
+                throw std::runtime_error( "failed" );
+            },
+            { .pool = &pool, .chunk_size = 16 }
+        ),
+        std::runtime_error
+    );
+}
+
+TEST_CASE(
+    "parallel_with_lock - runs from a task of its own pool",
+    "[parallel_with_lock]"
+)
+{
+    zdm::thread_pool                    pool( 1 );
+    std::vector<zdm::lock_wrapper<int>> wrappers( 100 );
+    std::promise<void>                  done;
+
+    pool.submit(
+        [&]()
+        {
+            zdm::parallel_with_lock(
+                wrappers,
+                []( int& value )
+                {
+                    ++value;
+                },
+                { .pool = &pool, .chunk_size = 8 }
+            );
+
+            done.set_value();
+        }
+    );
+
+    done.get_future().get();
+
+    for( auto& wrapper : wrappers )
+    {
+        REQUIRE( *wrapper == 1 );
+    }
+}
+
+TEST_CASE(
+    "parallel_with_lock - zero try passes locks in order",
+    "[parallel_with_lock]"
+)
+{
+    zdm::thread_pool                    pool( 1 );
+    std::vector<zdm::lock_wrapper<int>> wrappers( 10 );
+    std::vector<int>                    order;
+    std::atomic<bool>                   held{ false };
+
+    for( int i = 0; i < 10; ++i )
+    {
+        wrappers[static_cast<std::size_t>( i )].with_lock(
+            [i]( int& value )
+            {
+                value = i;
+            }
+        );
+    }
+
+    std::thread holder(
+        [&]()
+        {
+            wrappers[0].with_lock(
+                [&]( int& )
+                {
+                    held.store( true );
+                    std::this_thread::sleep_for(
+                        std::chrono::milliseconds( 10 )
+                    );
+                }
+            );
+        }
+    );
+
+    while( !held.load() )
+    {
+        std::this_thread::yield();
+    }
+
+    zdm::parallel_with_lock(
+        wrappers,
+        [&]( const int& value )
+        {
+            order.push_back( value );
+        },
+        { .pool = &pool, .max_threads = 1, .try_passes = 0 }
+    );
+
+    holder.join();
+
+    std::vector<int> expected( 10 );
+    std::iota( expected.begin(), expected.end(), 0 );
+
+    REQUIRE( order == expected );
+}
+
+TEST_CASE(
+    "with_lock_parallel - scans partitions under one shared lock",
+    "[parallel_with_lock]"
+)
+{
+    zdm::thread_pool                           pool( 4 );
+    zdm::shared_lock_wrapper<std::vector<int>> rows(
+        std::vector<int>( 100'003, 1 )
+    );
+
+    std::atomic<bool> writer_blocked{ true };
+
+    const auto sums = zdm::with_lock_parallel(
+        rows,
+        [&]( const auto& a_partition )
+        {
+            // A thread of its own: the caller also runs partitions, and
+            // must not try to lock a mutex it holds.
+            std::thread(
+                [&]()
+                {
+                    if( rows.try_with_lock(
+                            []( std::vector<int>& )
+                            {
+                            }
+                        ) )
+                    {
+                        writer_blocked = false;
+                    }
+                }
+            ).join();
+
+            long sum = 0;
+
+            for( const int row : a_partition )
+            {
+                sum += row;
+            }
+
+            return sum;
+        },
+        8,
+        { .pool = &pool }
+    );
+
+    REQUIRE( writer_blocked );
+    REQUIRE( sums.size() == 8 );
+    REQUIRE( std::accumulate( sums.begin(), sums.end(), 0L ) == 100'003 );
+
+    std::atomic<std::size_t> visited{ 0 };
+
+    zdm::with_lock_parallel(
+        rows,
+        [&visited]( const auto& a_partition )
+        {
+            visited += a_partition.size();
+        },
+        0,
+        { .pool = &pool }
+    );
+
+    REQUIRE( visited == 100'003 );
+}
+
+TEST_CASE(
+    "with_lock_parallel - clamps partitions and rethrows errors",
+    "[parallel_with_lock]"
+)
+{
+    zdm::thread_pool                    pool( 2 );
+    zdm::lock_wrapper<std::vector<int>> small( std::vector<int>{ 1, 2, 3 } );
+
+    const auto sizes = zdm::with_lock_parallel(
+        small,
+        []( const auto& a_partition )
+        {
+            return a_partition.size();
+        },
+        16,
+        { .pool = &pool }
+    );
+
+    REQUIRE( sizes == std::vector<std::size_t>{ 1, 1, 1 } );
+
+    zdm::lock_wrapper<std::vector<int>> empty( std::vector<int>{} );
+
+    const auto none = zdm::with_lock_parallel(
+        empty,
+        []( const auto& a_partition )
+        {
+            return a_partition.size();
+        },
+        4,
+        { .pool = &pool }
+    );
+
+    REQUIRE( none.empty() );
+
+    REQUIRE_THROWS_AS(
+        zdm::with_lock_parallel(
+            small,
+            []( const auto& a_partition )
+            {
+                if( a_partition.front() == 2 )
+                {
+                    throw std::runtime_error( "bad row" );
+                }
+            },
+            3,
+            { .pool = &pool }
+        ),
+        std::runtime_error
+    );
+
+    // The lock is released after an error.
+    REQUIRE( small.try_with_lock(
+        []( std::vector<int>& a_values )
+        {
+            a_values.push_back( 4 );
+        }
+    ) );
+}
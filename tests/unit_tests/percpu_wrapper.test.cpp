@@ -0,0 +1,81 @@
+#include <catch2/catch_all.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <zdm/percpu_wrapper.hpp>
+
+TEST_CASE(
+    "percpu_wrapper - folds the updates of every thread",
+    "[percpu_wrapper]"
+)
+{
+    constexpr std::uint64_t threads_count = 8;
+    constexpr std::uint64_t increments    = 20'000;
+
+    zdm::percpu_wrapper<std::uint64_t> counter;
+    std::vector<std::thread>           threads;
+
+    REQUIRE( counter.slot_count() >= 1 );
+
+    for( std::uint64_t t = 0; t < threads_count; ++t )
+    {
+        threads.emplace_back(
+            [&counter]
+            {
+                for( std::uint64_t i = 0; i < increments; ++i )
+                {
+                    counter.with_lock(
+                        []( std::uint64_t& a_count )
+                        {
+                            ++a_count;
+                        }
+                    );
+                }
+            }
+        );
+    }
+
+    for( auto &thread : threads )
+    {
+        thread.join();
+    }
+
+    const auto total = counter.fold(
+        std::uint64_t{ 0 },
+        []( std::uint64_t a_total, const std::uint64_t& a_count )
+        {
+            return a_total + a_count;
+        }
+    );
+
+    REQUIRE( total == threads_count * increments );
+}
+
+TEST_CASE(
+    "percpu_wrapper - starts every slot from the initial value",
+    "[percpu_wrapper]"
+)
+{
+    zdm::percpu_wrapper<std::vector<int>> lists( std::vector<int>{ 1 } );
+
+    const auto size = lists.with_lock(
+        []( std::vector<int>& a_list )
+        {
+            a_list.push_back( 2 );
+            return a_list.size();
+        }
+    );
+
+    REQUIRE( size == 2 );
+
+    const auto elements = lists.fold(
+        std::size_t{ 0 },
+        []( std::size_t a_total, const std::vector<int>& a_list )
+        {
+            return a_total + a_list.size();
+        }
+    );
+
+    REQUIRE( elements == lists.slot_count() + 1 );
+}
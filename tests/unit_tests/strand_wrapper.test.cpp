@@ -0,0 +1,208 @@
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+#include <zdm/strand_wrapper.hpp>
+
+TEST_CASE(
+    "strand_wrapper - posted functions run in submission order",
+    "[strand_wrapper]"
+)
+{
+    zdm::thread_pool pool( 4 );
+    std::vector<int> result;
+
+    {
+        zdm::strand_wrapper<std::vector<int>> wrapper( pool, {} );
+
+        for( int i = 0; i < 1000; ++i )
+        {
+            wrapper.post(
+                [i]( std::vector<int>& values )
+                {
+                    values.push_back( i );
+                }
+            );
+        }
+
+        wrapper.post(
+            [&result]( std::vector<int>& values )
+            {
+                result = values;
+            }
+        );
+    }
+
+    REQUIRE( result.size() == 1000 );
+
+    for( int i = 0; i < 1000; ++i )
+    {
+        REQUIRE( result[static_cast<std::size_t>( i )] == i );
+    }
+}
+
+TEST_CASE(
+    "strand_wrapper - posts from many threads are serialized",
+    "[strand_wrapper]"
+)
+{
+    constexpr int    number_of_threads = 4;
+    zdm::thread_pool pool( 4 );
+    int              result = 0;
+
+    {
+        zdm::strand_wrapper<int> wrapper( pool, 0 );
+        std::vector<std::thread> threads;
+
+        for( int t = 0; t < number_of_threads; ++t )
+        {
+            threads.emplace_back(
+                [&wrapper]()
+                {
+                    for( int i = 0; i < 250; ++i )
+                    {
+                        wrapper.post(
+                            []( int& value )
+                            {
+                                ++value;
+                            }
+                        );
+                    }
+                }
+            );
+        }
+
+        for( auto& thread : threads )
+        {
+            thread.join();
+        }
+
+        wrapper.post(
+            [&result]( int& value )
+            {
+                result = value;
+            }
+        );
+    }
+
+    REQUIRE( result == 1000 );
+}
+
+TEST_CASE(
+    "strand_wrapper - dispatch runs inline on the strand",
+    "[strand_wrapper]"
+)
+{
+    zdm::thread_pool pool( 2 );
+    std::vector<int> result;
+    bool             running_in_strand = false;
+
+    {
+        zdm::strand_wrapper<std::vector<int>> wrapper( pool, {} );
+
+        wrapper.post(
+            [&]( std::vector<int>& values )
+            {
+                values.push_back( 1 );
+                running_in_strand = wrapper.running_in_this_thread();
+
+                wrapper.post(
+                    []( std::vector<int>& inner )
+                    {
+                        inner.push_back( 3 );
+                    }
+                );
+                wrapper.post(
+                    [&result]( std::vector<int>& inner )
+                    {
+                        result = inner;
+                    }
+                );
+                wrapper.dispatch(
+                    []( std::vector<int>& inner )
+                    {
+                        inner.push_back( 2 );
+                    }
+                );
+            }
+        );
+    }
+
+    REQUIRE( running_in_strand );
+    REQUIRE( result == std::vector<int>{ 1, 2, 3 } );
+}
+
+TEST_CASE(
+    "strand_wrapper - with_lock observes posted mutations",
+    "[strand_wrapper]"
+)
+{
+    zdm::thread_pool                pool( 1 );
+    zdm::shared_strand_wrapper<int> wrapper( pool, 41 );
+
+    REQUIRE_FALSE( wrapper.running_in_this_thread() );
+
+    wrapper.with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+
+    auto result = wrapper.with_lock(
+        []( const int& value )
+        {
+            return value;
+        }
+    );
+
+    REQUIRE( result == 42 );
+}
+
+TEST_CASE(
+    "strand_wrapper - pool threads do not block while with_lock holds",
+    "[strand_wrapper]"
+)
+{
+    zdm::thread_pool         pool( 1 );
+    zdm::strand_wrapper<int> wrapper( pool, 0 );
+    std::promise<void>       pool_free;
+    std::future_status       status = std::future_status::timeout;
+
+    wrapper.with_lock(
+        [&]( int& value )
+        {
+            wrapper.post(
+                []( int& a_value )
+                {
+                    a_value *= 10;
+                }
+            );
+            pool.submit(
+                [&pool_free]()
+                {
+                    pool_free.set_value();
+                }
+            );
+
+            // The strand must leave the only pool thread to the task above.
+            status = pool_free.get_future().wait_for(
+                std::chrono::seconds( 10 )
+            );
+            value = 4;
+        }
+    );
+
+    REQUIRE( status == std::future_status::ready );
+
+    std::promise<int> result;
+    wrapper.post(
+        [&result]( int& a_value )
+        {
+            result.set_value( a_value );
+        }
+    );
+
+    REQUIRE( result.get_future().get() == 40 );
+}
@@ -0,0 +1,146 @@
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <zdm/wait_any.hpp>
+
+TEST_CASE(
+    "versioned_mutex - only exclusive unlocks change the version",
+    "[wait_any]"
+)
+{
+    zdm::versioned_shared_lock_wrapper<int> wrapper( 0 );
+
+    REQUIRE( wrapper.mutex().version() == 0 );
+
+    wrapper.with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+
+    REQUIRE( wrapper.mutex().version() == 1 );
+
+    auto value = wrapper.with_lock(
+        []( const int& contained )
+        {
+            return contained;
+        }
+    );
+
+    REQUIRE( value == 1 );
+    REQUIRE( wrapper.mutex().version() == 1 );
+}
+
+TEST_CASE(
+    "wait_any - returns immediately for a change since the snapshot",
+    "[wait_any]"
+)
+{
+    zdm::versioned_lock_wrapper<int> first( 0 );
+    zdm::versioned_lock_wrapper<int> second( 0 );
+
+    auto                             seen = zdm::versions( first, second );
+
+    second.with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+
+    REQUIRE( zdm::wait_any( seen, first, second ) == 1 );
+    REQUIRE( seen == zdm::versions( first, second ) );
+}
+
+TEST_CASE(
+    "wait_any - wakes up when another thread modifies a wrapper",
+    "[wait_any]"
+)
+{
+    zdm::versioned_lock_wrapper<int>        first( 0 );
+    zdm::versioned_shared_lock_wrapper<int> second( 0 );
+    zdm::versioned_lock_wrapper<int>        third( 0 );
+
+    auto        seen    = zdm::versions( first, second, third );
+    std::size_t changed = 0;
+
+    std::thread waiter(
+        [&]()
+        {
+            changed = zdm::wait_any( seen, first, second, third );
+        }
+    );
+
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+
+    third.with_lock(
+        []( int& value )
+        {
+            value = 3;
+        }
+    );
+
+    waiter.join();
+
+    REQUIRE( changed == 2 );
+    REQUIRE( seen[2] == 1 );
+}
+
+TEST_CASE(
+    "wait_any - only flags the wrappers waited on",
+    "[wait_any]"
+)
+{
+    zdm::versioned_lock_wrapper<int> watched( 0 );
+    zdm::versioned_lock_wrapper<int> other( 0 );
+
+    auto                             seen    = zdm::versions( watched );
+    std::size_t                      changed = 1;
+
+    std::thread                      waiter(
+        [&]()
+        {
+            changed = zdm::wait_any( seen, watched );
+        }
+    );
+
+    while( ( watched.mutex().version_word().load()
+             & zdm::detail::version_waiting_bit )
+           == 0 )
+    {
+        std::this_thread::yield();
+    }
+
+    other.with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+
+    REQUIRE(
+        ( other.mutex().version_word().load()
+          & zdm::detail::version_waiting_bit )
+        == 0
+    );
+    REQUIRE( other.mutex().version() == 1 );
+
+    watched.with_lock(
+        []( int& value )
+        {
+            ++value;
+        }
+    );
+
+    waiter.join();
+
+    REQUIRE( changed == 0 );
+    REQUIRE( seen[0] == 1 );
+    REQUIRE(
+        ( watched.mutex().version_word().load()
+          & zdm::detail::version_waiting_bit )
+        == 0
+    );
+}